@@ -1,16 +1,83 @@
+//mmap()等POSIX接口在严格的C99模式下需要显式声明
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "lynxjson.h"
 #include <assert.h>
-#include <stdlib.h> //NULL, strtod(), malloc(), realloc(), free()
-#include <math.h>	//HUGE_VAL
-#include <errno.h>	//errno, ERANGE
+#include <stdlib.h> //NULL, malloc(), realloc(), free()
+#include <math.h>	//isfinite(), signbit()
+#include <float.h>	//FLT_EVAL_METHOD
+#include <stdint.h>	//uint64_t
 #include <string.h>	//memcpy()
-#include <stdio.h>	//sprintf()
+#include <stdio.h>	//sprintf(), fopen()
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>	//CreateFileMapping(), MapViewOfFile()
+#include <io.h>		//_write()
+#define LYNX_HAVE_MMAP
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>		//open()
+#include <unistd.h>		//close(), sysconf(), write()
+#include <errno.h>		//EINTR
+#include <sys/mman.h>	//mmap(), posix_madvise()
+#include <sys/stat.h>	//fstat()
+#define LYNX_HAVE_MMAP
+#ifndef LYNX_NO_THREADS
+#include <pthread.h>	//pthread_create()
+#endif
+#else
+#define LYNX_NO_THREADS	//没有可用的线程接口，多线程解析退化为在调用线程中顺序执行
+#endif
+
+/*
+内存分配
+	库中所有的内存申请/释放都经过lynx_allocator。节点（字符串、数组、对象）的存储空间总是使用全局分配器，
+	因为lynx_free()等接口没有分配器参数；解析栈、lynx_stringify_ex()的输出缓冲区、文档的arena则使用调用时指定的分配器。
+*/
+static void* lynx_default_malloc(void* ud, size_t size) { (void)ud; return malloc(size); }
+static void* lynx_default_realloc(void* ud, void* ptr, size_t size) { (void)ud; return realloc(ptr, size); }
+static void lynx_default_free(void* ud, void* ptr) { (void)ud; free(ptr); }
+
+static const lynx_allocator lynx_default_allocator = { lynx_default_malloc, lynx_default_realloc, lynx_default_free, NULL };
+static lynx_allocator lynx_global_allocator = { lynx_default_malloc, lynx_default_realloc, lynx_default_free, NULL };
+
+void lynx_set_allocator(const lynx_allocator* a)
+{
+	lynx_global_allocator = a ? *a : lynx_default_allocator;
+}
+
+const lynx_allocator* lynx_get_allocator(void)
+{
+	return &lynx_global_allocator;
+}
+
+#define LYNX_MALLOC(a, size)		((a)->malloc((a)->ud, (size)))
+#define LYNX_REALLOC(a, ptr, size)	((a)->realloc((a)->ud, (ptr), (size)))
+#define LYNX_FREE(a, ptr)			((a)->free((a)->ud, (ptr)))
+//节点存储空间使用的全局分配器
+#define MALLOC(size)		LYNX_MALLOC(&lynx_global_allocator, size)
+#define REALLOC(ptr, size)	LYNX_REALLOC(&lynx_global_allocator, ptr, size)
+#define FREE(ptr)			LYNX_FREE(&lynx_global_allocator, ptr)
 
 //为了减少解析解析函数之间传递的参数个数，把这些参数都放进一个结构体中
 typedef struct {
 	const char* json;	//指向当前处理的位置
+	const char* end;	//输入的结尾，所有读取都不会超过这里（'\0'结尾的输入指向'\0'）
+	const char* limit;	//SIMD扫描可以整块读取的范围，不小于end，见lynx_parse_options::padding
 	char* stack;	//在解析字符串、数组、对象等未知大小的元素时使用
 	size_t size, top;//栈的容量及栈顶
+	const lynx_allocator* allocator;	//栈使用的分配器
+	int insitu;		//原地解析模式，字符串直接在输入缓冲区中解码，见lynx_parse_insitu()
+	size_t max_depth;	//数组/对象的最大嵌套层数
+	lynx_document* doc;	//不为NULL时，解析出的字符串、数组、对象都从文档的arena中分配
+	lynx_key_table* keys;	//不为NULL时，对象的键引用键表中的副本
+	const lynx_handler* handler;	//只用于lynx_parse_sax()
+	void* handler_ctx;
+	lynx_write_fn write;	//只用于lynx_stringify_to()：不为NULL时栈是固定大小的输出缓冲区，写满时交给write输出
+	void* write_ctx;
+	int write_error;	//write返回过非0，之后的输出都丢弃
 } lynx_context;
 
 //可以在编译选项中自行设置宏，没有设置的话就使用缺省值
@@ -18,6 +85,14 @@ typedef struct {
 #define LYNX_PARSE_STACK_INIT_SIZE (1 << 8) //栈的初始容量（字节）
 #endif
 
+//把输出缓冲区中的内容交给write，清空缓冲区
+static void lynx_context_flush(lynx_context* c)
+{
+	if (c->top && !c->write_error && c->write(c->write_ctx, c->stack, c->top))
+		c->write_error = 1;
+	c->top = 0;
+}
+
 //进栈指定的字节数，返回指向栈顶内存的指针（以方便赋值操作）
 //注意：不要保存此函数的返回值！
 //当栈扩容后，用户之前保存的指向栈中元素的指针会失效！
@@ -26,13 +101,20 @@ static void* lynx_context_push(lynx_context* c, size_t size)
 	void* ret;
 	assert(size > 0);
 	if (c->top + size >= c->size) {
+		if (c->write) {
+			lynx_context_flush(c);
+			assert(size < c->size);	//输出时每次进栈都很小（见LYNX_DTOA_BUFFER_SIZE），不会超过缓冲区
+			ret = c->stack;
+			c->top = size;
+			return ret;
+		}
 		if (c->size == 0) {
 			c->size = LYNX_PARSE_STACK_INIT_SIZE;
 		}
 		while (c->top + size >= c->size) {
 			c->size += c->size >> 1;
 		}
-		c->stack = (char*)realloc(c->stack, c->size);
+		c->stack = (char*)LYNX_REALLOC(c->allocator, c->stack, c->size);
 	}
 	ret = c->stack + c->top;
 	c->top += size;
@@ -46,20 +128,757 @@ static void* lynx_context_pop(lynx_context* c, size_t size)
 	return c->stack + (c->top -= size);
 }
 
+/*
+文档（lynx_document）的arena分配器
+	从大块内存中顺序切分，不支持单独释放，销毁文档时整块释放。
+	arena中的字符串、数组、对象的节点带有LYNX_FLAG_BORROWED标记，lynx_free不会释放它们的存储空间。
+	arena中的数组、对象同时带有LYNX_FLAG_DOCUMENT标记，存储空间之前是所属文档的指针，对象的索引也在arena中。
+	修改它们需要扩容时（如lynx_pushback_array_element）复制到文档记录的内存块中（见lynx_document_block），
+	所以销毁文档时只需释放arena和这些内存块，不需要遍历节点。
+*/
+#ifndef LYNX_ARENA_CHUNK_SIZE
+#define LYNX_ARENA_CHUNK_SIZE (1 << 12)	//第一块的大小（字节），之后每块翻倍
+#endif
+#ifndef LYNX_ARENA_CHUNK_MAX_SIZE
+#define LYNX_ARENA_CHUNK_MAX_SIZE (1 << 20)
+#endif
+#define LYNX_ARENA_ALIGN 8
+
+typedef struct lynx_arena_chunk lynx_arena_chunk;
+struct lynx_arena_chunk {
+	lynx_arena_chunk* next;
+	size_t size;	//数据区的大小，数据紧跟在块头之后
+};
+
+/*
+文档记录的内存块
+	修改文档中的数组/对象时申请的存储空间（以及新增的键、重建的索引）使用文档的分配器，串在文档的双向链表中。
+	节点带有LYNX_FLAG_DOCUMENT而没有LYNX_FLAG_BORROWED，存储空间的布局与堆上的相同，lynx_free把它交还给文档。
+	块头的最后是所属文档的指针，与arena中的布局一致：两种存储空间之前都紧挨着文档的指针。
+*/
+typedef struct lynx_document_block lynx_document_block;
+struct lynx_document_block {
+	lynx_document_block *prev, *next;
+};
+
+struct lynx_document {
+	lynx_value root;
+	lynx_arena_chunk* chunks;	//链表头是当前正在使用的块
+	lynx_document_block* blocks;	//修改节点时申请的内存块
+	char *cur, *end;			//当前块中的空闲区间
+	size_t next_size;			//下一次申请的块大小
+	char* stack;				//解析用的栈，在多次解析之间复用
+	size_t stack_size;
+	lynx_allocator allocator;	//arena和栈使用的分配器
+	lynx_key_table* keys;		//见lynx_document_set_key_table()
+};
+
+//块头占用的大小（对齐到LYNX_ARENA_ALIGN）及块头之后的数据区
+#define LYNX_ARENA_HEADER_SIZE ((sizeof(lynx_arena_chunk) + LYNX_ARENA_ALIGN - 1) & ~(size_t)(LYNX_ARENA_ALIGN - 1))
+#define LYNX_ARENA_CHUNK_DATA(chunk) ((char*)(chunk) + LYNX_ARENA_HEADER_SIZE)
+
+//存储空间之前的文档指针占用的大小，以及由存储空间得到所属文档
+#define LYNX_DOCUMENT_PTR_SIZE ((sizeof(lynx_document*) + LYNX_ARENA_ALIGN - 1) & ~(size_t)(LYNX_ARENA_ALIGN - 1))
+#define LYNX_DOCUMENT_OF(p) (*(lynx_document**)((char*)(p) - sizeof(lynx_document*)))
+#define LYNX_DOCUMENT_BLOCK_SIZE (((sizeof(lynx_document_block) + LYNX_ARENA_ALIGN - 1) & ~(size_t)(LYNX_ARENA_ALIGN - 1)) + LYNX_DOCUMENT_PTR_SIZE)
+#define LYNX_DOCUMENT_BLOCK(p) ((lynx_document_block*)((char*)(p) - LYNX_DOCUMENT_BLOCK_SIZE))
+
+static void* lynx_arena_alloc(lynx_document* doc, size_t size)
+{
+	void* ret;
+	size = (size + LYNX_ARENA_ALIGN - 1) & ~(size_t)(LYNX_ARENA_ALIGN - 1);
+	if ((size_t)(doc->end - doc->cur) < size) {
+		lynx_arena_chunk* chunk;
+		size_t chunk_size = doc->next_size;
+		if (chunk_size < size) chunk_size = size;	//超过块大小的申请单独占用一块
+		chunk = (lynx_arena_chunk*)LYNX_MALLOC(&doc->allocator, LYNX_ARENA_HEADER_SIZE + chunk_size);
+		chunk->size = chunk_size;
+		chunk->next = doc->chunks;
+		doc->chunks = chunk;
+		doc->cur = LYNX_ARENA_CHUNK_DATA(chunk);
+		doc->end = doc->cur + chunk_size;
+		if (doc->next_size < LYNX_ARENA_CHUNK_MAX_SIZE) doc->next_size <<= 1;
+	}
+	ret = doc->cur;
+	doc->cur += size;
+	return ret;
+}
+
+//释放arena中的所有块，保留最近申请的一块（也是最大的一块）供下次使用
+static void lynx_arena_reset(lynx_document* doc)
+{
+	lynx_arena_chunk* chunk = doc->chunks;
+	if (!chunk) return;
+	while (chunk->next) {
+		lynx_arena_chunk* next = chunk->next->next;
+		LYNX_FREE(&doc->allocator, chunk->next);
+		chunk->next = next;
+	}
+	doc->cur = LYNX_ARENA_CHUNK_DATA(chunk);
+	doc->end = doc->cur + chunk->size;
+}
+
+//从arena中申请前面带有文档指针的存储空间（数组/对象）
+static void* lynx_arena_alloc_owned(lynx_document* doc, size_t size)
+{
+	char* p = (char*)lynx_arena_alloc(doc, LYNX_DOCUMENT_PTR_SIZE + size) + LYNX_DOCUMENT_PTR_SIZE;
+	LYNX_DOCUMENT_OF(p) = doc;
+	return p;
+}
+
+static void lynx_document_link(lynx_document* doc, lynx_document_block* b)
+{
+	b->prev = NULL;
+	b->next = doc->blocks;
+	if (b->next) b->next->prev = b;
+	doc->blocks = b;
+}
+
+static void lynx_document_unlink(lynx_document* doc, lynx_document_block* b)
+{
+	if (b->prev) b->prev->next = b->next; else doc->blocks = b->next;
+	if (b->next) b->next->prev = b->prev;
+}
+
+//申请一块由文档记录的内存，返回块头之后的数据区
+static void* lynx_document_alloc(lynx_document* doc, size_t size)
+{
+	lynx_document_block* b = (lynx_document_block*)LYNX_MALLOC(&doc->allocator, LYNX_DOCUMENT_BLOCK_SIZE + size);
+	char* p = (char*)b + LYNX_DOCUMENT_BLOCK_SIZE;
+	lynx_document_link(doc, b);
+	LYNX_DOCUMENT_OF(p) = doc;
+	return p;
+}
+
+static void* lynx_document_realloc(void* p, size_t size)
+{
+	lynx_document* doc = LYNX_DOCUMENT_OF(p);
+	lynx_document_block* b = LYNX_DOCUMENT_BLOCK(p);
+	lynx_document_unlink(doc, b);
+	b = (lynx_document_block*)LYNX_REALLOC(&doc->allocator, b, LYNX_DOCUMENT_BLOCK_SIZE + size);
+	lynx_document_link(doc, b);
+	return (char*)b + LYNX_DOCUMENT_BLOCK_SIZE;
+}
+
+static void lynx_document_release(void* p)
+{
+	lynx_document* doc = LYNX_DOCUMENT_OF(p);
+	lynx_document_block* b = LYNX_DOCUMENT_BLOCK(p);
+	lynx_document_unlink(doc, b);
+	LYNX_FREE(&doc->allocator, b);
+}
+
+//释放文档记录的所有内存块
+static void lynx_document_release_all(lynx_document* doc)
+{
+	while (doc->blocks) {
+		lynx_document_block* next = doc->blocks->next;
+		LYNX_FREE(&doc->allocator, doc->blocks);
+		doc->blocks = next;
+	}
+}
+
+/*
+对象的哈希索引
+	成员数达到LYNX_OBJECT_INDEX_THRESHOLD的对象（或调用过lynx_build_object_index()的对象）带有LYNX_FLAG_INDEXED标记，
+	成员数组之前紧挨着一个索引头，记录一张开放寻址的哈希表，表中存放成员的下标，成员本身仍按插入顺序存放在数组中。
+	哈希表与成员数组来自同一处（全局分配器、arena或文档记录的内存块）；索引头和成员数组在同一块存储空间中，随成员数组一起扩容、释放（位于arena时不释放）。
+*/
+#ifndef LYNX_OBJECT_INDEX_THRESHOLD
+#define LYNX_OBJECT_INDEX_THRESHOLD 16
+#endif
+
+typedef struct lynx_index_slot {
+	uint32_t hash;
+	uint32_t pos;	//成员下标 + 1，0表示空位
+} lynx_index_slot;
+
+typedef struct lynx_object_index {
+	lynx_index_slot* slots;
+	size_t mask;	//哈希表大小 - 1，大小是2的幂，装载率不超过1/2
+} lynx_object_index;
+
+#define LYNX_INDEX_HEADER_SIZE ((sizeof(lynx_object_index) + 7) & ~(size_t)7)	//保证成员数组仍然8字节对齐
+#define LYNX_OBJECT_INDEX(v) ((lynx_object_index*)((char*)(v)->u.m - LYNX_INDEX_HEADER_SIZE))
+
+/*
+数组/对象的容量
+	节点自己申请的存储空间开头是容量头，之后是元素/成员数组（对象有索引时索引头在两者之间），所以lynx_value中不必保存容量。
+	不属于节点的存储空间（arena中）没有容量头，容量就是元素/成员个数。
+*/
+#define LYNX_CAPACITY_HEADER_SIZE ((sizeof(lynx_size) + 7) & ~(size_t)7)
+
+//存储空间中元素/成员数组之前的头的大小
+static size_t lynx_storage_header(const lynx_value* v)
+{
+	size_t n = (v->flags & LYNX_FLAG_BORROWED) ? 0 : LYNX_CAPACITY_HEADER_SIZE;
+	return v->type == LYNX_OBJECT && (v->flags & LYNX_FLAG_INDEXED) ? n + LYNX_INDEX_HEADER_SIZE : n;
+}
+
+//存储空间的起始地址，没有时为NULL
+static char* lynx_storage(const lynx_value* v)
+{
+	char* p = v->type == LYNX_ARRAY ? (char*)v->u.e : (char*)v->u.m;
+	return p ? p - lynx_storage_header(v) : NULL;
+}
+
+static size_t lynx_storage_capacity(const lynx_value* v)
+{
+	const char* p;
+	if (v->flags & LYNX_FLAG_BORROWED) return v->size;
+	p = lynx_storage(v);
+	return p ? *(const lynx_size*)p : 0;
+}
+
+//数组/对象的存储空间所属的文档，不属于文档时为NULL
+static lynx_document* lynx_storage_document(const lynx_value* v)
+{
+	return (v->flags & LYNX_FLAG_DOCUMENT) ? LYNX_DOCUMENT_OF(lynx_storage(v)) : NULL;
+}
+
+//节点存储空间的申请/释放：doc不为NULL时由文档记录，否则使用全局分配器
+static void* lynx_node_alloc(lynx_document* doc, size_t size)
+{
+	return doc ? lynx_document_alloc(doc, size) : MALLOC(size);
+}
+
+static void* lynx_node_realloc(lynx_document* doc, void* p, size_t size)
+{
+	return doc ? lynx_document_realloc(p, size) : REALLOC(p, size);
+}
+
+static void lynx_node_free(lynx_document* doc, void* p)
+{
+	if (doc) lynx_document_release(p); else FREE(p);
+}
+
+/*
+短字符串（LYNX_FLAG_SHORT）
+	内容存放在节点开头的LYNX_SHORT_STRING_MAX + 1个字节中，最后一个字节记录LYNX_SHORT_STRING_MAX - 长度，
+	长度恰好为LYNX_SHORT_STRING_MAX时它同时是结尾的'\0'。对象的键也是字符串节点，同样适用。
+*/
+#define LYNX_STRING_DATA(v) ((v)->flags & LYNX_FLAG_SHORT ? (const char*)(v) : (const char*)(v)->u.s)
+#define LYNX_STRING_LENGTH(v) ((v)->flags & LYNX_FLAG_SHORT ?\
+	LYNX_SHORT_STRING_MAX - ((const unsigned char*)(v))[LYNX_SHORT_STRING_MAX] : (size_t)(v)->size)
+#define LYNX_KEY(m) LYNX_STRING_DATA(&(m)->k)
+#define LYNX_KEY_LENGTH(m) LYNX_STRING_LENGTH(&(m)->k)
+
+//FNV-1a
+static uint32_t lynx_hash_key(const char* key, size_t klen)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < klen; ++i) {
+		h ^= (unsigned char)key[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+/*
+键表（lynx_key_table）
+	相同的键只保存一份只读的副本，副本之前记录着它的长度和哈希。
+	引用键表的键带有LYNX_FLAG_BORROWED | LYNX_FLAG_INTERNED标记，建立索引时直接使用记录的哈希；短键直接存放在节点中，不经过键表。
+	开放寻址的哈希表中存放副本的指针，装载率不超过1/2。键表只增不减，不是线程安全的。
+*/
+typedef struct lynx_key_entry {
+	uint32_t hash;	//lynx_hash_key(s, len)
+	size_t len;
+	char s[];
+} lynx_key_entry;
+
+struct lynx_key_table {
+	lynx_key_entry** slots;
+	size_t mask;	//哈希表大小 - 1，没有哈希表时为0
+	size_t size;	//不同的键的个数
+};
+
+#define LYNX_KEY_ENTRY(str) ((const lynx_key_entry*)((const char*)(str) - offsetof(lynx_key_entry, s)))
+
+//成员的键的哈希
+static uint32_t lynx_member_hash(const lynx_member* m)
+{
+	if (m->k.flags & LYNX_FLAG_INTERNED) return LYNX_KEY_ENTRY(m->k.u.s)->hash;
+	return lynx_hash_key(LYNX_KEY(m), LYNX_KEY_LENGTH(m));
+}
+
+lynx_key_table* lynx_key_table_create(void)
+{
+	lynx_key_table* t = (lynx_key_table*)MALLOC(sizeof(lynx_key_table));
+	t->slots = NULL;
+	t->mask = t->size = 0;
+	return t;
+}
+
+void lynx_key_table_destroy(lynx_key_table* t)
+{
+	if (!t) return;
+	if (t->slots) {
+		for (size_t i = 0; i <= t->mask; ++i)
+			if (t->slots[i]) FREE(t->slots[i]);
+		FREE(t->slots);
+	}
+	FREE(t);
+}
+
+size_t lynx_key_table_size(const lynx_key_table* t)
+{
+	assert(t != NULL);
+	return t->size;
+}
+
+static lynx_key_entry** lynx_key_table_slot(const lynx_key_table* t, const char* key, size_t klen, uint32_t hash)
+{
+	size_t i = hash & t->mask;
+	for (; t->slots[i]; i = (i + 1) & t->mask) {
+		const lynx_key_entry* e = t->slots[i];
+		if (e->hash == hash && e->len == klen && memcmp(e->s, key, klen) == 0) break;
+	}
+	return &t->slots[i];
+}
+
+const char* lynx_key_table_find(const lynx_key_table* t, const char* key, size_t klen)
+{
+	assert(t != NULL && (key != NULL || klen == 0));
+	if (!t->slots) return NULL;
+	lynx_key_entry* e = *lynx_key_table_slot(t, key, klen, lynx_hash_key(key, klen));
+	return e ? e->s : NULL;
+}
+
+//返回key在键表中的副本，没有时加入
+static const char* lynx_key_table_intern(lynx_key_table* t, const char* key, size_t klen)
+{
+	uint32_t hash = lynx_hash_key(key, klen);
+	lynx_key_entry **slot, *e;
+	if (!t->slots || (t->size + 1) * 2 > t->mask + 1) {
+		lynx_key_entry** old = t->slots;
+		size_t n = old ? t->mask + 1 : 0;
+		t->mask = old ? n * 2 - 1 : 63;
+		t->slots = (lynx_key_entry**)MALLOC((t->mask + 1) * sizeof(lynx_key_entry*));
+		memset(t->slots, 0, (t->mask + 1) * sizeof(lynx_key_entry*));
+		for (size_t i = 0; i < n; ++i) {
+			if (!old[i]) continue;
+			size_t j = old[i]->hash & t->mask;
+			while (t->slots[j]) j = (j + 1) & t->mask;
+			t->slots[j] = old[i];
+		}
+		if (old) FREE(old);
+	}
+	slot = lynx_key_table_slot(t, key, klen, hash);
+	if (!*slot) {
+		e = (lynx_key_entry*)MALLOC(offsetof(lynx_key_entry, s) + klen + 1);
+		e->hash = hash;
+		e->len = klen;
+		memcpy(e->s, key, klen);
+		e->s[klen] = '\0';
+		*slot = e;
+		++t->size;
+	}
+	return (*slot)->s;
+}
+
+static void lynx_index_insert(lynx_object_index* idx, uint32_t hash, size_t pos)
+{
+	size_t i = hash & idx->mask;
+	while (idx->slots[i].pos) i = (i + 1) & idx->mask;
+	idx->slots[i].hash = hash;
+	idx->slots[i].pos = (uint32_t)pos + 1;
+}
+
+//按当前的成员重建哈希表，必要时调整表的大小
+static void lynx_index_rebuild(lynx_value* v)
+{
+	lynx_object_index* idx = LYNX_OBJECT_INDEX(v);
+	lynx_document* doc = lynx_storage_document(v);
+	size_t n = 8;
+	assert(v->size < UINT32_MAX);
+	while (n < v->size * 2) n <<= 1;
+	if (!idx->slots || idx->mask + 1 != n) {
+		if (doc && (v->flags & LYNX_FLAG_BORROWED)) {
+			//arena中的对象，旧的哈希表随arena一起释放
+			idx->slots = (lynx_index_slot*)lynx_arena_alloc(doc, n * sizeof(lynx_index_slot));
+		} else {
+			if (idx->slots) lynx_node_free(doc, idx->slots);
+			idx->slots = (lynx_index_slot*)lynx_node_alloc(doc, n * sizeof(lynx_index_slot));
+		}
+		idx->mask = n - 1;
+	}
+	memset(idx->slots, 0, n * sizeof(lynx_index_slot));
+	for (size_t i = 0; i < v->size; ++i)
+		lynx_index_insert(idx, lynx_member_hash(&v->u.m[i]), i);
+}
+
+//把最后一个成员加入索引
+static void lynx_index_push(lynx_value* v)
+{
+	lynx_object_index* idx = LYNX_OBJECT_INDEX(v);
+	const lynx_member* m = &(v->u.m[v->size - 1]);
+	if (v->size * 2 > idx->mask + 1)
+		lynx_index_rebuild(v);
+	else
+		lynx_index_insert(idx, lynx_member_hash(m), v->size - 1);
+}
+
+//hash为lynx_hash_key(key, klen)，调用者可以预先计算好（见lynx_path）
+static size_t lynx_index_find_hashed(const lynx_value* v, const char* key, size_t klen, uint32_t hash)
+{
+	const lynx_object_index* idx = LYNX_OBJECT_INDEX(v);
+	for (size_t i = hash & idx->mask; idx->slots[i].pos; i = (i + 1) & idx->mask) {
+		if (idx->slots[i].hash == hash) {
+			const lynx_member* m = &(v->u.m[idx->slots[i].pos - 1]);
+			//通过键表得到的键可以只比较指针
+			if (LYNX_KEY_LENGTH(m) == klen && (LYNX_KEY(m) == key || memcmp(LYNX_KEY(m), key, klen) == 0))
+				return idx->slots[i].pos - 1;
+		}
+	}
+	return LYNX_KEY_NOT_EXIST;
+}
+
+static size_t lynx_index_find(const lynx_value* v, const char* key, size_t klen)
+{
+	return lynx_index_find_hashed(v, key, klen, lynx_hash_key(key, klen));
+}
 
 #define EXPECT(c, ch) do {\
-	assert(*((c)->json) == (ch));\
+	assert((c)->json != (c)->end && *((c)->json) == (ch));\
 	(c)->json++;\
 } while(0)
 
+//当前位置的字符，到达输入结尾时视为'\0'
+#define PEEK(c) ((c)->json != (c)->end ? *(c)->json : '\0')
+
+/*
+SIMD加速
+	在x86/x64平台上提供SSE2和AVX2版本的扫描函数，首次使用时根据CPU支持情况选择具体实现（运行时分派）。
+	可在编译选项中定义LYNX_DISABLE_SIMD，强制只使用逐字节的标量实现。
+	扫描范围是[p, end)，整块读取只在块完全位于[p, limit)之内时进行，剩下的尾部逐字节处理。
+	limit即输入之后可以安全读取的位置：默认等于end，所以不会读到输入之外；
+	调用者保证输入之后有填充字节时（见lynx_parse_options::padding）limit可以超过end，此时停在end之后的结果按end处理。
+*/
+#if !defined(LYNX_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LYNX_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 5))
+#define LYNX_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(LYNX_AVX2) && !defined(_MSC_VER)
+#define LYNX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LYNX_TARGET_AVX2
+#endif
+
+#define ISWS(ch) ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+
+//返回最低位的1所在的位置，x不能为0
+static unsigned lynx_ctz32(unsigned x)
+{
+	assert(x != 0);
+#if defined(_MSC_VER)
+	unsigned long r;
+	_BitScanForward(&r, x);
+	return (unsigned)r;
+#elif defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctz(x);
+#else
+	unsigned r = 0;
+	while (!(x & 1)) { x >>= 1; ++r; }
+	return r;
+#endif
+}
+
+//返回最低位的1所在的位置，x不能为0
+static unsigned lynx_ctz64(uint64_t x)
+{
+	assert(x != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long r;
+	_BitScanForward64(&r, x);
+	return (unsigned)r;
+#elif defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll(x);
+#else
+	return (uint32_t)x ? lynx_ctz32((unsigned)(uint32_t)x) : 32 + lynx_ctz32((unsigned)(x >> 32));
+#endif
+}
+
 //ws = *(%x20 / %x09 / %x0A / %x0D)
+//各个版本的空白跳过函数，返回[p, end)中第一个非空白字符的位置，全部是空白时返回end
+static const char* lynx_skip_whitespace_scalar(const char* p, const char* end, const char* limit)
+{
+	(void)limit;
+	while (p != end && ISWS(*p))
+		++p;
+	return p;
+}
+
+#ifdef LYNX_SSE2
+static const char* lynx_skip_whitespace_sse2(const char* p, const char* end, const char* limit)
+{
+	const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+	const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+	for (; p < end && limit - p >= 16; p += 16) {
+		__m128i s = _mm_loadu_si128((const __m128i*)p);
+		__m128i x = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, sp), _mm_cmpeq_epi8(s, tab)),
+			_mm_or_si128(_mm_cmpeq_epi8(s, lf), _mm_cmpeq_epi8(s, cr)));
+		unsigned mask = (unsigned)_mm_movemask_epi8(x) ^ 0xFFFFu;	//非空白字符对应的位为1
+		if (mask) {
+			p += lynx_ctz32(mask);
+			return p < end ? p : end;
+		}
+	}
+	return p < end ? lynx_skip_whitespace_scalar(p, end, limit) : end;
+}
+#endif
+
+#ifdef LYNX_AVX2
+LYNX_TARGET_AVX2
+static const char* lynx_skip_whitespace_avx2(const char* p, const char* end, const char* limit)
+{
+	const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+	const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+	for (; p < end && limit - p >= 32; p += 32) {
+		__m256i s = _mm256_loadu_si256((const __m256i*)p);
+		__m256i x = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(s, sp), _mm256_cmpeq_epi8(s, tab)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(s, lf), _mm256_cmpeq_epi8(s, cr)));
+		unsigned mask = ~(unsigned)_mm256_movemask_epi8(x);
+		if (mask) {
+			p += lynx_ctz32(mask);
+			return p < end ? p : end;
+		}
+	}
+	return p < end ? lynx_skip_whitespace_scalar(p, end, limit) : end;
+}
+#endif
+
+//字符串扫描函数，返回[p, end)中第一个需要特殊处理的字符（'\"'、'\\'或控制字符，包括'\0'）的位置，没有时返回end
+//在此之前的字节可以整段复制
+#define ISSTRSPECIAL(ch) ((ch) == '\"' || (ch) == '\\' || (unsigned char)(ch) < 0x20)
+
+static const char* lynx_scan_string_scalar(const char* p, const char* end, const char* limit)
+{
+	(void)limit;
+	while (p != end && !ISSTRSPECIAL(*p))
+		++p;
+	return p;
+}
+
+#ifdef LYNX_SSE2
+static const char* lynx_scan_string_sse2(const char* p, const char* end, const char* limit)
+{
+	const __m128i dq = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\'), ctrl = _mm_set1_epi8(0x1F);
+	for (; p < end && limit - p >= 16; p += 16) {
+		__m128i s = _mm_loadu_si128((const __m128i*)p);
+		//无符号比较s <= 0x1F等价于max(s, 0x1F) == 0x1F
+		__m128i x = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, dq), _mm_cmpeq_epi8(s, bs)),
+			_mm_cmpeq_epi8(_mm_max_epu8(s, ctrl), ctrl));
+		unsigned mask = (unsigned)_mm_movemask_epi8(x);
+		if (mask) {
+			p += lynx_ctz32(mask);
+			return p < end ? p : end;
+		}
+	}
+	return p < end ? lynx_scan_string_scalar(p, end, limit) : end;
+}
+#endif
+
+#ifdef LYNX_AVX2
+LYNX_TARGET_AVX2
+static const char* lynx_scan_string_avx2(const char* p, const char* end, const char* limit)
+{
+	const __m256i dq = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\'), ctrl = _mm256_set1_epi8(0x1F);
+	for (; p < end && limit - p >= 32; p += 32) {
+		__m256i s = _mm256_loadu_si256((const __m256i*)p);
+		__m256i x = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(s, dq), _mm256_cmpeq_epi8(s, bs)),
+			_mm256_cmpeq_epi8(_mm256_max_epu8(s, ctrl), ctrl));
+		unsigned mask = (unsigned)_mm256_movemask_epi8(x);
+		if (mask) {
+			p += lynx_ctz32(mask);
+			return p < end ? p : end;
+		}
+	}
+	return p < end ? lynx_scan_string_scalar(p, end, limit) : end;
+}
+#endif
+
+//块分类函数：求出p开始的64个字节中各类字符的位置（第i位对应p[i]），用于lynx_tape的第一阶段
+typedef struct {
+	uint64_t quote, backslash, ws;
+	uint64_t op;	//结构字符：{ } [ ] : ,
+} lynx_block;
+
+static void lynx_classify_scalar(const char* p, lynx_block* b)
+{
+	unsigned i;
+	b->quote = b->backslash = b->ws = b->op = 0;
+	for (i = 0; i < 64; ++i) {
+		uint64_t bit = (uint64_t)1 << i;
+		switch (p[i]) {
+			case '\"': b->quote |= bit; break;
+			case '\\': b->backslash |= bit; break;
+			case ' ': case '\t': case '\n': case '\r': b->ws |= bit; break;
+			case '{': case '}': case '[': case ']': case ':': case ',': b->op |= bit; break;
+		}
+	}
+}
+
+#ifdef LYNX_SSE2
+static void lynx_classify_sse2(const char* p, lynx_block* b)
+{
+	const __m128i dq = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\');
+	const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+	const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+	const __m128i lower = _mm_set1_epi8(0x20), lc = _mm_set1_epi8('{'), rc = _mm_set1_epi8('}');
+	const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(',');
+	unsigned i;
+	b->quote = b->backslash = b->ws = b->op = 0;
+	for (i = 0; i < 64; i += 16) {
+		__m128i s = _mm_loadu_si128((const __m128i*)(p + i));
+		__m128i l = _mm_or_si128(s, lower);	//'['和']'加上0x20就是'{'和'}'
+		__m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, sp), _mm_cmpeq_epi8(s, tab)),
+			_mm_or_si128(_mm_cmpeq_epi8(s, lf), _mm_cmpeq_epi8(s, cr)));
+		__m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(l, lc), _mm_cmpeq_epi8(l, rc)),
+			_mm_or_si128(_mm_cmpeq_epi8(s, colon), _mm_cmpeq_epi8(s, comma)));
+		b->quote |= (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(s, dq)) << i;
+		b->backslash |= (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(s, bs)) << i;
+		b->ws |= (uint64_t)(unsigned)_mm_movemask_epi8(ws) << i;
+		b->op |= (uint64_t)(unsigned)_mm_movemask_epi8(op) << i;
+	}
+}
+#endif
+
+#ifdef LYNX_AVX2
+LYNX_TARGET_AVX2
+static void lynx_classify_avx2(const char* p, lynx_block* b)
+{
+	const __m256i dq = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\');
+	const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+	const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+	const __m256i lower = _mm256_set1_epi8(0x20), lc = _mm256_set1_epi8('{'), rc = _mm256_set1_epi8('}');
+	const __m256i colon = _mm256_set1_epi8(':'), comma = _mm256_set1_epi8(',');
+	unsigned i;
+	b->quote = b->backslash = b->ws = b->op = 0;
+	for (i = 0; i < 64; i += 32) {
+		__m256i s = _mm256_loadu_si256((const __m256i*)(p + i));
+		__m256i l = _mm256_or_si256(s, lower);
+		__m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(s, sp), _mm256_cmpeq_epi8(s, tab)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(s, lf), _mm256_cmpeq_epi8(s, cr)));
+		__m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(l, lc), _mm256_cmpeq_epi8(l, rc)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(s, colon), _mm256_cmpeq_epi8(s, comma)));
+		b->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, dq)) << i;
+		b->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, bs)) << i;
+		b->ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << i;
+		b->op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << i;
+	}
+}
+#endif
+
+//运行时检测CPU是否支持AVX2（同时要求操作系统保存YMM寄存器）
+static int lynx_cpu_has_avx2(void)
+{
+#if defined(LYNX_AVX2) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return 0;
+	__cpuid(info, 1);
+	if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) return 0;	//OSXSAVE, AVX
+	if ((_xgetbv(0) & 6) != 6) return 0;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(LYNX_AVX2)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return 0;
+#endif
+}
+
+typedef const char* (*lynx_scan_fn)(const char* p, const char* end, const char* limit);
+typedef void (*lynx_classify_fn)(const char* p, lynx_block* b);
+
+/*
+	选定的实现保存在全局的函数指针中，初值是各自的_init版本，第一次调用时选定实现并写回指针。
+	多个线程可能同时第一次调用，因此指针的读写都是原子的（relaxed即可：各线程选出的实现相同，也不经由指针发布其他数据），
+	在x86上与普通的读写是同一条指令，不影响扫描的开销。
+*/
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define LYNX_ATOMIC(T) _Atomic(T)
+#define LYNX_ATOMIC_LOAD(x) atomic_load_explicit(&(x), memory_order_relaxed)
+#define LYNX_ATOMIC_STORE(x, v) atomic_store_explicit(&(x), (v), memory_order_relaxed)
+#elif defined(__GNUC__) || defined(__clang__)
+#define LYNX_ATOMIC(T) T
+#define LYNX_ATOMIC_LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define LYNX_ATOMIC_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#else
+//MSVC上对齐的指针大小的volatile读写是原子的
+#define LYNX_ATOMIC(T) T volatile
+#define LYNX_ATOMIC_LOAD(x) (x)
+#define LYNX_ATOMIC_STORE(x, v) ((x) = (v))
+#endif
+
+static const char* lynx_skip_whitespace_init(const char* p, const char* end, const char* limit);
+static const char* lynx_scan_string_init(const char* p, const char* end, const char* limit);
+static void lynx_classify_init(const char* p, lynx_block* b);
+static LYNX_ATOMIC(lynx_scan_fn) lynx_skip_whitespace_impl = lynx_skip_whitespace_init;
+static LYNX_ATOMIC(lynx_scan_fn) lynx_scan_string_impl = lynx_scan_string_init;
+static LYNX_ATOMIC(lynx_classify_fn) lynx_classify_impl = lynx_classify_init;
+//通过当前选定的实现调用
+#define lynx_skip_whitespace(p, end, limit) (LYNX_ATOMIC_LOAD(lynx_skip_whitespace_impl)((p), (end), (limit)))
+#define lynx_scan_string(p, end, limit) (LYNX_ATOMIC_LOAD(lynx_scan_string_impl)((p), (end), (limit)))
+#define lynx_classify(p, b) (LYNX_ATOMIC_LOAD(lynx_classify_impl)((p), (b)))
+
+//根据CPU特性选择各扫描函数的实现，只由_init版本调用，重复调用结果相同
+static void lynx_simd_init(void)
+{
+	lynx_scan_fn ws = lynx_skip_whitespace_scalar, str = lynx_scan_string_scalar;
+	lynx_classify_fn cls = lynx_classify_scalar;
+#ifdef LYNX_SSE2
+	ws = lynx_skip_whitespace_sse2;
+	str = lynx_scan_string_sse2;
+	cls = lynx_classify_sse2;
+#endif
+#ifdef LYNX_AVX2
+	if (lynx_cpu_has_avx2()) {
+		ws = lynx_skip_whitespace_avx2;
+		str = lynx_scan_string_avx2;
+		cls = lynx_classify_avx2;
+	}
+#endif
+	LYNX_ATOMIC_STORE(lynx_skip_whitespace_impl, ws);
+	LYNX_ATOMIC_STORE(lynx_scan_string_impl, str);
+	LYNX_ATOMIC_STORE(lynx_classify_impl, cls);
+}
+
+static const char* lynx_skip_whitespace_init(const char* p, const char* end, const char* limit)
+{
+	lynx_simd_init();
+	return lynx_skip_whitespace(p, end, limit);
+}
+
+static const char* lynx_scan_string_init(const char* p, const char* end, const char* limit)
+{
+	lynx_simd_init();
+	return lynx_scan_string(p, end, limit);
+}
+
+static void lynx_classify_init(const char* p, lynx_block* b)
+{
+	lynx_simd_init();
+	lynx_classify(p, b);
+}
+
 //跳过连续的空白字符, 此函数不会出错
 static void lynx_parse_whitespace(lynx_context* c)
 {
-	const char *p = c->json;
-	while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
-		++p;
-	c->json = p;
+	//紧凑的JSON中大部分位置没有空白，先判断一个字节，避免不必要的函数调用
+	if (c->json != c->end && ISWS(*c->json))
+		c->json = lynx_skip_whitespace(c->json + 1, c->end, c->limit);
 }
 
 //解析字面量，如false，true，null
@@ -69,7 +888,7 @@ static int lynx_parse_literal(lynx_context* c, lynx_value* v, const char* s, lyn
 	const char *p = s + 1, *q = c->json;
 	size_t len = 0;
 	while (*p) {
-		if (*p++ != *q++) {
+		if (q == c->end || *p++ != *q++) {
 			return LYNX_PARSE_INVALID_VALUE;
 		}
 		++len;
@@ -92,9 +911,10 @@ static unsigned hex_to_dec(char ch)
 }
 
 #define PUTC(c, ch) do { *(char*)lynx_context_push((c), sizeof(char)) = (ch); } while (0)
+#define PUTS(c, s, len) memcpy(lynx_context_push(c, len), s, len)
 
-//将码点翻译为对应的UTF8编码进栈
-static void lynx_encode_utf8(lynx_context* c, unsigned u)
+//将码点翻译为对应的UTF8编码写入buf（至多4字节），返回编码长度
+static size_t lynx_encode_utf8(char* buf, unsigned u)
 {
 	assert(0x0000 <= u && u <= 0x10FFFF);
 	/*
@@ -108,30 +928,34 @@ static void lynx_encode_utf8(lynx_context* c, unsigned u)
 
 	//x & 0xFF这种操作是为了避免编译器的警告
 	if (u <= 0x007F) {
-		PUTC(c, u & 0xFF);	//感谢gdb
+		buf[0] = u & 0xFF;	//感谢gdb
+		return 1;
 	} else											
 	if (u <= 0x07FF) {
-		PUTC(c, 0xC0 | ((u >> 6) & 0xFF));		//0xC0 = 11000000	
-		PUTC(c, 0x80 | (u & 0x3F));				//0x3F = 00111111
+		buf[0] = 0xC0 | ((u >> 6) & 0xFF);		//0xC0 = 11000000	
+		buf[1] = 0x80 | (u & 0x3F);				//0x3F = 00111111
+		return 2;
 	} else										//0x80 = 10000000
 	if (u <= 0xFFFF) {
-		PUTC(c, 0xE0 | ((u >> 12) & 0x0F));
-		PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-		PUTC(c, 0x80 | (u & 0x3F));
-	} else
-	if (u <= 0x10FFFF) {
-		PUTC(c, 0xF0 | ((u >> 18) & 0xF7));
-		PUTC(c, 0x80 | ((u >> 12) & 0x3F));
-		PUTC(c, 0x80 | ((u >> 6) & 0x3F));
-		PUTC(c, 0x80 | (u & 0x3F));
+		buf[0] = 0xE0 | ((u >> 12) & 0x0F);
+		buf[1] = 0x80 | ((u >> 6) & 0x3F);
+		buf[2] = 0x80 | (u & 0x3F);
+		return 3;
+	} else {
+		buf[0] = 0xF0 | ((u >> 18) & 0xF7);
+		buf[1] = 0x80 | ((u >> 12) & 0x3F);
+		buf[2] = 0x80 | ((u >> 6) & 0x3F);
+		buf[3] = 0x80 | (u & 0x3F);
+		return 4;
 	}
 }
 
 //解析字符串中\u后面的四位十六进制数
 //成功返回p的位置，失败返回NULL
-static const char* lynx_parse_hex4(const char* p, unsigned *u)
+static const char* lynx_parse_hex4(const char* p, const char* end, unsigned *u)
 {
 	*u = 0;
+	if (end - p < 4) return NULL;
 	for (int i = 0; i < 4; ++i) {
 		*u <<= 4;
 		if (ISHEX(p[i])) *u |= hex_to_dec(p[i]);
@@ -140,90 +964,1065 @@ static const char* lynx_parse_hex4(const char* p, unsigned *u)
 	return p + 4;
 }	
 
-//为了简单起见，使用标准库的strtod()将读取的字符串数字转化为浮点数
-static int lynx_parse_number(lynx_context* c, lynx_value* v)
+/*
+十进制数字转换为double（不使用strtod，与locale无关，结果总是正确舍入的）
+	1. 快速路径：有效数字不超过19位、可以精确表示为double且10的幂次不超过22时，一次浮点乘除法即可得到正确结果
+	2. Eisel-Lemire算法：用预先计算的128位5的幂与尾数相乘，得到正确舍入的结果（有效数字不超过19位时总是成立）
+	3. 精确回退：有效数字超过19位且截断会影响舍入时，用大整数比较输入值与两个候选值中点的大小
+*/
+#define LYNX_POW10_MIN (-342)	//比这更小的值一定会舍入为0
+#define LYNX_POW10_MAX 308		//比这更大的值一定会溢出
+
+//5^q的128位近似值（规格化，最高位为1），q = LYNX_POW10_MIN ... LYNX_POW10_MAX
+static const uint64_t lynx_pow5_128[][2] = {
+	{0xEEF453D6923BD65Au, 0x113FAA2906A13B3Fu},
+	{0x9558B4661B6565F8u, 0x4AC7CA59A424C507u},
+	{0xBAAEE17FA23EBF76u, 0x5D79BCF00D2DF649u},
+	{0xE95A99DF8ACE6F53u, 0xF4D82C2C107973DCu},
+	{0x91D8A02BB6C10594u, 0x79071B9B8A4BE869u},
+	{0xB64EC836A47146F9u, 0x9748E2826CDEE284u},
+	{0xE3E27A444D8D98B7u, 0xFD1B1B2308169B25u},
+	{0x8E6D8C6AB0787F72u, 0xFE30F0F5E50E20F7u},
+	{0xB208EF855C969F4Fu, 0xBDBD2D335E51A935u},
+	{0xDE8B2B66B3BC4723u, 0xAD2C788035E61382u},
+	{0x8B16FB203055AC76u, 0x4C3BCB5021AFCC31u},
+	{0xADDCB9E83C6B1793u, 0xDF4ABE242A1BBF3Du},
+	{0xD953E8624B85DD78u, 0xD71D6DAD34A2AF0Du},
+	{0x87D4713D6F33AA6Bu, 0x8672648C40E5AD68u},
+	{0xA9C98D8CCB009506u, 0x680EFDAF511F18C2u},
+	{0xD43BF0EFFDC0BA48u, 0x0212BD1B2566DEF2u},
+	{0x84A57695FE98746Du, 0x014BB630F7604B57u},
+	{0xA5CED43B7E3E9188u, 0x419EA3BD35385E2Du},
+	{0xCF42894A5DCE35EAu, 0x52064CAC828675B9u},
+	{0x818995CE7AA0E1B2u, 0x7343EFEBD1940993u},
+	{0xA1EBFB4219491A1Fu, 0x1014EBE6C5F90BF8u},
+	{0xCA66FA129F9B60A6u, 0xD41A26E077774EF6u},
+	{0xFD00B897478238D0u, 0x8920B098955522B4u},
+	{0x9E20735E8CB16382u, 0x55B46E5F5D5535B0u},
+	{0xC5A890362FDDBC62u, 0xEB2189F734AA831Du},
+	{0xF712B443BBD52B7Bu, 0xA5E9EC7501D523E4u},
+	{0x9A6BB0AA55653B2Du, 0x47B233C92125366Eu},
+	{0xC1069CD4EABE89F8u, 0x999EC0BB696E840Au},
+	{0xF148440A256E2C76u, 0xC00670EA43CA250Du},
+	{0x96CD2A865764DBCAu, 0x380406926A5E5728u},
+	{0xBC807527ED3E12BCu, 0xC605083704F5ECF2u},
+	{0xEBA09271E88D976Bu, 0xF7864A44C633682Eu},
+	{0x93445B8731587EA3u, 0x7AB3EE6AFBE0211Du},
+	{0xB8157268FDAE9E4Cu, 0x5960EA05BAD82964u},
+	{0xE61ACF033D1A45DFu, 0x6FB92487298E33BDu},
+	{0x8FD0C16206306BABu, 0xA5D3B6D479F8E056u},
+	{0xB3C4F1BA87BC8696u, 0x8F48A4899877186Cu},
+	{0xE0B62E2929ABA83Cu, 0x331ACDABFE94DE87u},
+	{0x8C71DCD9BA0B4925u, 0x9FF0C08B7F1D0B14u},
+	{0xAF8E5410288E1B6Fu, 0x07ECF0AE5EE44DD9u},
+	{0xDB71E91432B1A24Au, 0xC9E82CD9F69D6150u},
+	{0x892731AC9FAF056Eu, 0xBE311C083A225CD2u},
+	{0xAB70FE17C79AC6CAu, 0x6DBD630A48AAF406u},
+	{0xD64D3D9DB981787Du, 0x092CBBCCDAD5B108u},
+	{0x85F0468293F0EB4Eu, 0x25BBF56008C58EA5u},
+	{0xA76C582338ED2621u, 0xAF2AF2B80AF6F24Eu},
+	{0xD1476E2C07286FAAu, 0x1AF5AF660DB4AEE1u},
+	{0x82CCA4DB847945CAu, 0x50D98D9FC890ED4Du},
+	{0xA37FCE126597973Cu, 0xE50FF107BAB528A0u},
+	{0xCC5FC196FEFD7D0Cu, 0x1E53ED49A96272C8u},
+	{0xFF77B1FCBEBCDC4Fu, 0x25E8E89C13BB0F7Au},
+	{0x9FAACF3DF73609B1u, 0x77B191618C54E9ACu},
+	{0xC795830D75038C1Du, 0xD59DF5B9EF6A2417u},
+	{0xF97AE3D0D2446F25u, 0x4B0573286B44AD1Du},
+	{0x9BECCE62836AC577u, 0x4EE367F9430AEC32u},
+	{0xC2E801FB244576D5u, 0x229C41F793CDA73Fu},
+	{0xF3A20279ED56D48Au, 0x6B43527578C1110Fu},
+	{0x9845418C345644D6u, 0x830A13896B78AAA9u},
+	{0xBE5691EF416BD60Cu, 0x23CC986BC656D553u},
+	{0xEDEC366B11C6CB8Fu, 0x2CBFBE86B7EC8AA8u},
+	{0x94B3A202EB1C3F39u, 0x7BF7D71432F3D6A9u},
+	{0xB9E08A83A5E34F07u, 0xDAF5CCD93FB0CC53u},
+	{0xE858AD248F5C22C9u, 0xD1B3400F8F9CFF68u},
+	{0x91376C36D99995BEu, 0x23100809B9C21FA1u},
+	{0xB58547448FFFFB2Du, 0xABD40A0C2832A78Au},
+	{0xE2E69915B3FFF9F9u, 0x16C90C8F323F516Cu},
+	{0x8DD01FAD907FFC3Bu, 0xAE3DA7D97F6792E3u},
+	{0xB1442798F49FFB4Au, 0x99CD11CFDF41779Cu},
+	{0xDD95317F31C7FA1Du, 0x40405643D711D583u},
+	{0x8A7D3EEF7F1CFC52u, 0x482835EA666B2572u},
+	{0xAD1C8EAB5EE43B66u, 0xDA3243650005EECFu},
+	{0xD863B256369D4A40u, 0x90BED43E40076A82u},
+	{0x873E4F75E2224E68u, 0x5A7744A6E804A291u},
+	{0xA90DE3535AAAE202u, 0x711515D0A205CB36u},
+	{0xD3515C2831559A83u, 0x0D5A5B44CA873E03u},
+	{0x8412D9991ED58091u, 0xE858790AFE9486C2u},
+	{0xA5178FFF668AE0B6u, 0x626E974DBE39A872u},
+	{0xCE5D73FF402D98E3u, 0xFB0A3D212DC8128Fu},
+	{0x80FA687F881C7F8Eu, 0x7CE66634BC9D0B99u},
+	{0xA139029F6A239F72u, 0x1C1FFFC1EBC44E80u},
+	{0xC987434744AC874Eu, 0xA327FFB266B56220u},
+	{0xFBE9141915D7A922u, 0x4BF1FF9F0062BAA8u},
+	{0x9D71AC8FADA6C9B5u, 0x6F773FC3603DB4A9u},
+	{0xC4CE17B399107C22u, 0xCB550FB4384D21D3u},
+	{0xF6019DA07F549B2Bu, 0x7E2A53A146606A48u},
+	{0x99C102844F94E0FBu, 0x2EDA7444CBFC426Du},
+	{0xC0314325637A1939u, 0xFA911155FEFB5308u},
+	{0xF03D93EEBC589F88u, 0x793555AB7EBA27CAu},
+	{0x96267C7535B763B5u, 0x4BC1558B2F3458DEu},
+	{0xBBB01B9283253CA2u, 0x9EB1AAEDFB016F16u},
+	{0xEA9C227723EE8BCBu, 0x465E15A979C1CADCu},
+	{0x92A1958A7675175Fu, 0x0BFACD89EC191EC9u},
+	{0xB749FAED14125D36u, 0xCEF980EC671F667Bu},
+	{0xE51C79A85916F484u, 0x82B7E12780E7401Au},
+	{0x8F31CC0937AE58D2u, 0xD1B2ECB8B0908810u},
+	{0xB2FE3F0B8599EF07u, 0x861FA7E6DCB4AA15u},
+	{0xDFBDCECE67006AC9u, 0x67A791E093E1D49Au},
+	{0x8BD6A141006042BDu, 0xE0C8BB2C5C6D24E0u},
+	{0xAECC49914078536Du, 0x58FAE9F773886E18u},
+	{0xDA7F5BF590966848u, 0xAF39A475506A899Eu},
+	{0x888F99797A5E012Du, 0x6D8406C952429603u},
+	{0xAAB37FD7D8F58178u, 0xC8E5087BA6D33B83u},
+	{0xD5605FCDCF32E1D6u, 0xFB1E4A9A90880A64u},
+	{0x855C3BE0A17FCD26u, 0x5CF2EEA09A55067Fu},
+	{0xA6B34AD8C9DFC06Fu, 0xF42FAA48C0EA481Eu},
+	{0xD0601D8EFC57B08Bu, 0xF13B94DAF124DA26u},
+	{0x823C12795DB6CE57u, 0x76C53D08D6B70858u},
+	{0xA2CB1717B52481EDu, 0x54768C4B0C64CA6Eu},
+	{0xCB7DDCDDA26DA268u, 0xA9942F5DCF7DFD09u},
+	{0xFE5D54150B090B02u, 0xD3F93B35435D7C4Cu},
+	{0x9EFA548D26E5A6E1u, 0xC47BC5014A1A6DAFu},
+	{0xC6B8E9B0709F109Au, 0x359AB6419CA1091Bu},
+	{0xF867241C8CC6D4C0u, 0xC30163D203C94B62u},
+	{0x9B407691D7FC44F8u, 0x79E0DE63425DCF1Du},
+	{0xC21094364DFB5636u, 0x985915FC12F542E4u},
+	{0xF294B943E17A2BC4u, 0x3E6F5B7B17B2939Du},
+	{0x979CF3CA6CEC5B5Au, 0xA705992CEECF9C42u},
+	{0xBD8430BD08277231u, 0x50C6FF782A838353u},
+	{0xECE53CEC4A314EBDu, 0xA4F8BF5635246428u},
+	{0x940F4613AE5ED136u, 0x871B7795E136BE99u},
+	{0xB913179899F68584u, 0x28E2557B59846E3Fu},
+	{0xE757DD7EC07426E5u, 0x331AEADA2FE589CFu},
+	{0x9096EA6F3848984Fu, 0x3FF0D2C85DEF7621u},
+	{0xB4BCA50B065ABE63u, 0x0FED077A756B53A9u},
+	{0xE1EBCE4DC7F16DFBu, 0xD3E8495912C62894u},
+	{0x8D3360F09CF6E4BDu, 0x64712DD7ABBBD95Cu},
+	{0xB080392CC4349DECu, 0xBD8D794D96AACFB3u},
+	{0xDCA04777F541C567u, 0xECF0D7A0FC5583A0u},
+	{0x89E42CAAF9491B60u, 0xF41686C49DB57244u},
+	{0xAC5D37D5B79B6239u, 0x311C2875C522CED5u},
+	{0xD77485CB25823AC7u, 0x7D633293366B828Bu},
+	{0x86A8D39EF77164BCu, 0xAE5DFF9C02033197u},
+	{0xA8530886B54DBDEBu, 0xD9F57F830283FDFCu},
+	{0xD267CAA862A12D66u, 0xD072DF63C324FD7Bu},
+	{0x8380DEA93DA4BC60u, 0x4247CB9E59F71E6Du},
+	{0xA46116538D0DEB78u, 0x52D9BE85F074E608u},
+	{0xCD795BE870516656u, 0x67902E276C921F8Bu},
+	{0x806BD9714632DFF6u, 0x00BA1CD8A3DB53B6u},
+	{0xA086CFCD97BF97F3u, 0x80E8A40ECCD228A4u},
+	{0xC8A883C0FDAF7DF0u, 0x6122CD128006B2CDu},
+	{0xFAD2A4B13D1B5D6Cu, 0x796B805720085F81u},
+	{0x9CC3A6EEC6311A63u, 0xCBE3303674053BB0u},
+	{0xC3F490AA77BD60FCu, 0xBEDBFC4411068A9Cu},
+	{0xF4F1B4D515ACB93Bu, 0xEE92FB5515482D44u},
+	{0x991711052D8BF3C5u, 0x751BDD152D4D1C4Au},
+	{0xBF5CD54678EEF0B6u, 0xD262D45A78A0635Du},
+	{0xEF340A98172AACE4u, 0x86FB897116C87C34u},
+	{0x9580869F0E7AAC0Eu, 0xD45D35E6AE3D4DA0u},
+	{0xBAE0A846D2195712u, 0x8974836059CCA109u},
+	{0xE998D258869FACD7u, 0x2BD1A438703FC94Bu},
+	{0x91FF83775423CC06u, 0x7B6306A34627DDCFu},
+	{0xB67F6455292CBF08u, 0x1A3BC84C17B1D542u},
+	{0xE41F3D6A7377EECAu, 0x20CABA5F1D9E4A93u},
+	{0x8E938662882AF53Eu, 0x547EB47B7282EE9Cu},
+	{0xB23867FB2A35B28Du, 0xE99E619A4F23AA43u},
+	{0xDEC681F9F4C31F31u, 0x6405FA00E2EC94D4u},
+	{0x8B3C113C38F9F37Eu, 0xDE83BC408DD3DD04u},
+	{0xAE0B158B4738705Eu, 0x9624AB50B148D445u},
+	{0xD98DDAEE19068C76u, 0x3BADD624DD9B0957u},
+	{0x87F8A8D4CFA417C9u, 0xE54CA5D70A80E5D6u},
+	{0xA9F6D30A038D1DBCu, 0x5E9FCF4CCD211F4Cu},
+	{0xD47487CC8470652Bu, 0x7647C3200069671Fu},
+	{0x84C8D4DFD2C63F3Bu, 0x29ECD9F40041E073u},
+	{0xA5FB0A17C777CF09u, 0xF468107100525890u},
+	{0xCF79CC9DB955C2CCu, 0x7182148D4066EEB4u},
+	{0x81AC1FE293D599BFu, 0xC6F14CD848405530u},
+	{0xA21727DB38CB002Fu, 0xB8ADA00E5A506A7Cu},
+	{0xCA9CF1D206FDC03Bu, 0xA6D90811F0E4851Cu},
+	{0xFD442E4688BD304Au, 0x908F4A166D1DA663u},
+	{0x9E4A9CEC15763E2Eu, 0x9A598E4E043287FEu},
+	{0xC5DD44271AD3CDBAu, 0x40EFF1E1853F29FDu},
+	{0xF7549530E188C128u, 0xD12BEE59E68EF47Cu},
+	{0x9A94DD3E8CF578B9u, 0x82BB74F8301958CEu},
+	{0xC13A148E3032D6E7u, 0xE36A52363C1FAF01u},
+	{0xF18899B1BC3F8CA1u, 0xDC44E6C3CB279AC1u},
+	{0x96F5600F15A7B7E5u, 0x29AB103A5EF8C0B9u},
+	{0xBCB2B812DB11A5DEu, 0x7415D448F6B6F0E7u},
+	{0xEBDF661791D60F56u, 0x111B495B3464AD21u},
+	{0x936B9FCEBB25C995u, 0xCAB10DD900BEEC34u},
+	{0xB84687C269EF3BFBu, 0x3D5D514F40EEA742u},
+	{0xE65829B3046B0AFAu, 0x0CB4A5A3112A5112u},
+	{0x8FF71A0FE2C2E6DCu, 0x47F0E785EABA72ABu},
+	{0xB3F4E093DB73A093u, 0x59ED216765690F56u},
+	{0xE0F218B8D25088B8u, 0x306869C13EC3532Cu},
+	{0x8C974F7383725573u, 0x1E414218C73A13FBu},
+	{0xAFBD2350644EEACFu, 0xE5D1929EF90898FAu},
+	{0xDBAC6C247D62A583u, 0xDF45F746B74ABF39u},
+	{0x894BC396CE5DA772u, 0x6B8BBA8C328EB783u},
+	{0xAB9EB47C81F5114Fu, 0x066EA92F3F326564u},
+	{0xD686619BA27255A2u, 0xC80A537B0EFEFEBDu},
+	{0x8613FD0145877585u, 0xBD06742CE95F5F36u},
+	{0xA798FC4196E952E7u, 0x2C48113823B73704u},
+	{0xD17F3B51FCA3A7A0u, 0xF75A15862CA504C5u},
+	{0x82EF85133DE648C4u, 0x9A984D73DBE722FBu},
+	{0xA3AB66580D5FDAF5u, 0xC13E60D0D2E0EBBAu},
+	{0xCC963FEE10B7D1B3u, 0x318DF905079926A8u},
+	{0xFFBBCFE994E5C61Fu, 0xFDF17746497F7052u},
+	{0x9FD561F1FD0F9BD3u, 0xFEB6EA8BEDEFA633u},
+	{0xC7CABA6E7C5382C8u, 0xFE64A52EE96B8FC0u},
+	{0xF9BD690A1B68637Bu, 0x3DFDCE7AA3C673B0u},
+	{0x9C1661A651213E2Du, 0x06BEA10CA65C084Eu},
+	{0xC31BFA0FE5698DB8u, 0x486E494FCFF30A62u},
+	{0xF3E2F893DEC3F126u, 0x5A89DBA3C3EFCCFAu},
+	{0x986DDB5C6B3A76B7u, 0xF89629465A75E01Cu},
+	{0xBE89523386091465u, 0xF6BBB397F1135823u},
+	{0xEE2BA6C0678B597Fu, 0x746AA07DED582E2Cu},
+	{0x94DB483840B717EFu, 0xA8C2A44EB4571CDCu},
+	{0xBA121A4650E4DDEBu, 0x92F34D62616CE413u},
+	{0xE896A0D7E51E1566u, 0x77B020BAF9C81D17u},
+	{0x915E2486EF32CD60u, 0x0ACE1474DC1D122Eu},
+	{0xB5B5ADA8AAFF80B8u, 0x0D819992132456BAu},
+	{0xE3231912D5BF60E6u, 0x10E1FFF697ED6C69u},
+	{0x8DF5EFABC5979C8Fu, 0xCA8D3FFA1EF463C1u},
+	{0xB1736B96B6FD83B3u, 0xBD308FF8A6B17CB2u},
+	{0xDDD0467C64BCE4A0u, 0xAC7CB3F6D05DDBDEu},
+	{0x8AA22C0DBEF60EE4u, 0x6BCDF07A423AA96Bu},
+	{0xAD4AB7112EB3929Du, 0x86C16C98D2C953C6u},
+	{0xD89D64D57A607744u, 0xE871C7BF077BA8B7u},
+	{0x87625F056C7C4A8Bu, 0x11471CD764AD4972u},
+	{0xA93AF6C6C79B5D2Du, 0xD598E40D3DD89BCFu},
+	{0xD389B47879823479u, 0x4AFF1D108D4EC2C3u},
+	{0x843610CB4BF160CBu, 0xCEDF722A585139BAu},
+	{0xA54394FE1EEDB8FEu, 0xC2974EB4EE658828u},
+	{0xCE947A3DA6A9273Eu, 0x733D226229FEEA32u},
+	{0x811CCC668829B887u, 0x0806357D5A3F525Fu},
+	{0xA163FF802A3426A8u, 0xCA07C2DCB0CF26F7u},
+	{0xC9BCFF6034C13052u, 0xFC89B393DD02F0B5u},
+	{0xFC2C3F3841F17C67u, 0xBBAC2078D443ACE2u},
+	{0x9D9BA7832936EDC0u, 0xD54B944B84AA4C0Du},
+	{0xC5029163F384A931u, 0x0A9E795E65D4DF11u},
+	{0xF64335BCF065D37Du, 0x4D4617B5FF4A16D5u},
+	{0x99EA0196163FA42Eu, 0x504BCED1BF8E4E45u},
+	{0xC06481FB9BCF8D39u, 0xE45EC2862F71E1D6u},
+	{0xF07DA27A82C37088u, 0x5D767327BB4E5A4Cu},
+	{0x964E858C91BA2655u, 0x3A6A07F8D510F86Fu},
+	{0xBBE226EFB628AFEAu, 0x890489F70A55368Bu},
+	{0xEADAB0ABA3B2DBE5u, 0x2B45AC74CCEA842Eu},
+	{0x92C8AE6B464FC96Fu, 0x3B0B8BC90012929Du},
+	{0xB77ADA0617E3BBCBu, 0x09CE6EBB40173744u},
+	{0xE55990879DDCAABDu, 0xCC420A6A101D0515u},
+	{0x8F57FA54C2A9EAB6u, 0x9FA946824A12232Du},
+	{0xB32DF8E9F3546564u, 0x47939822DC96ABF9u},
+	{0xDFF9772470297EBDu, 0x59787E2B93BC56F7u},
+	{0x8BFBEA76C619EF36u, 0x57EB4EDB3C55B65Au},
+	{0xAEFAE51477A06B03u, 0xEDE622920B6B23F1u},
+	{0xDAB99E59958885C4u, 0xE95FAB368E45ECEDu},
+	{0x88B402F7FD75539Bu, 0x11DBCB0218EBB414u},
+	{0xAAE103B5FCD2A881u, 0xD652BDC29F26A119u},
+	{0xD59944A37C0752A2u, 0x4BE76D3346F0495Fu},
+	{0x857FCAE62D8493A5u, 0x6F70A4400C562DDBu},
+	{0xA6DFBD9FB8E5B88Eu, 0xCB4CCD500F6BB952u},
+	{0xD097AD07A71F26B2u, 0x7E2000A41346A7A7u},
+	{0x825ECC24C873782Fu, 0x8ED400668C0C28C8u},
+	{0xA2F67F2DFA90563Bu, 0x728900802F0F32FAu},
+	{0xCBB41EF979346BCAu, 0x4F2B40A03AD2FFB9u},
+	{0xFEA126B7D78186BCu, 0xE2F610C84987BFA8u},
+	{0x9F24B832E6B0F436u, 0x0DD9CA7D2DF4D7C9u},
+	{0xC6EDE63FA05D3143u, 0x91503D1C79720DBBu},
+	{0xF8A95FCF88747D94u, 0x75A44C6397CE912Au},
+	{0x9B69DBE1B548CE7Cu, 0xC986AFBE3EE11ABAu},
+	{0xC24452DA229B021Bu, 0xFBE85BADCE996168u},
+	{0xF2D56790AB41C2A2u, 0xFAE27299423FB9C3u},
+	{0x97C560BA6B0919A5u, 0xDCCD879FC967D41Au},
+	{0xBDB6B8E905CB600Fu, 0x5400E987BBC1C920u},
+	{0xED246723473E3813u, 0x290123E9AAB23B68u},
+	{0x9436C0760C86E30Bu, 0xF9A0B6720AAF6521u},
+	{0xB94470938FA89BCEu, 0xF808E40E8D5B3E69u},
+	{0xE7958CB87392C2C2u, 0xB60B1D1230B20E04u},
+	{0x90BD77F3483BB9B9u, 0xB1C6F22B5E6F48C2u},
+	{0xB4ECD5F01A4AA828u, 0x1E38AEB6360B1AF3u},
+	{0xE2280B6C20DD5232u, 0x25C6DA63C38DE1B0u},
+	{0x8D590723948A535Fu, 0x579C487E5A38AD0Eu},
+	{0xB0AF48EC79ACE837u, 0x2D835A9DF0C6D851u},
+	{0xDCDB1B2798182244u, 0xF8E431456CF88E65u},
+	{0x8A08F0F8BF0F156Bu, 0x1B8E9ECB641B58FFu},
+	{0xAC8B2D36EED2DAC5u, 0xE272467E3D222F3Fu},
+	{0xD7ADF884AA879177u, 0x5B0ED81DCC6ABB0Fu},
+	{0x86CCBB52EA94BAEAu, 0x98E947129FC2B4E9u},
+	{0xA87FEA27A539E9A5u, 0x3F2398D747B36224u},
+	{0xD29FE4B18E88640Eu, 0x8EEC7F0D19A03AADu},
+	{0x83A3EEEEF9153E89u, 0x1953CF68300424ACu},
+	{0xA48CEAAAB75A8E2Bu, 0x5FA8C3423C052DD7u},
+	{0xCDB02555653131B6u, 0x3792F412CB06794Du},
+	{0x808E17555F3EBF11u, 0xE2BBD88BBEE40BD0u},
+	{0xA0B19D2AB70E6ED6u, 0x5B6ACEAEAE9D0EC4u},
+	{0xC8DE047564D20A8Bu, 0xF245825A5A445275u},
+	{0xFB158592BE068D2Eu, 0xEED6E2F0F0D56712u},
+	{0x9CED737BB6C4183Du, 0x55464DD69685606Bu},
+	{0xC428D05AA4751E4Cu, 0xAA97E14C3C26B886u},
+	{0xF53304714D9265DFu, 0xD53DD99F4B3066A8u},
+	{0x993FE2C6D07B7FABu, 0xE546A8038EFE4029u},
+	{0xBF8FDB78849A5F96u, 0xDE98520472BDD033u},
+	{0xEF73D256A5C0F77Cu, 0x963E66858F6D4440u},
+	{0x95A8637627989AADu, 0xDDE7001379A44AA8u},
+	{0xBB127C53B17EC159u, 0x5560C018580D5D52u},
+	{0xE9D71B689DDE71AFu, 0xAAB8F01E6E10B4A6u},
+	{0x9226712162AB070Du, 0xCAB3961304CA70E8u},
+	{0xB6B00D69BB55C8D1u, 0x3D607B97C5FD0D22u},
+	{0xE45C10C42A2B3B05u, 0x8CB89A7DB77C506Au},
+	{0x8EB98A7A9A5B04E3u, 0x77F3608E92ADB242u},
+	{0xB267ED1940F1C61Cu, 0x55F038B237591ED3u},
+	{0xDF01E85F912E37A3u, 0x6B6C46DEC52F6688u},
+	{0x8B61313BBABCE2C6u, 0x2323AC4B3B3DA015u},
+	{0xAE397D8AA96C1B77u, 0xABEC975E0A0D081Au},
+	{0xD9C7DCED53C72255u, 0x96E7BD358C904A21u},
+	{0x881CEA14545C7575u, 0x7E50D64177DA2E54u},
+	{0xAA242499697392D2u, 0xDDE50BD1D5D0B9E9u},
+	{0xD4AD2DBFC3D07787u, 0x955E4EC64B44E864u},
+	{0x84EC3C97DA624AB4u, 0xBD5AF13BEF0B113Eu},
+	{0xA6274BBDD0FADD61u, 0xECB1AD8AEACDD58Eu},
+	{0xCFB11EAD453994BAu, 0x67DE18EDA5814AF2u},
+	{0x81CEB32C4B43FCF4u, 0x80EACF948770CED7u},
+	{0xA2425FF75E14FC31u, 0xA1258379A94D028Du},
+	{0xCAD2F7F5359A3B3Eu, 0x096EE45813A04330u},
+	{0xFD87B5F28300CA0Du, 0x8BCA9D6E188853FCu},
+	{0x9E74D1B791E07E48u, 0x775EA264CF55347Eu},
+	{0xC612062576589DDAu, 0x95364AFE032A819Eu},
+	{0xF79687AED3EEC551u, 0x3A83DDBD83F52205u},
+	{0x9ABE14CD44753B52u, 0xC4926A9672793543u},
+	{0xC16D9A0095928A27u, 0x75B7053C0F178294u},
+	{0xF1C90080BAF72CB1u, 0x5324C68B12DD6339u},
+	{0x971DA05074DA7BEEu, 0xD3F6FC16EBCA5E04u},
+	{0xBCE5086492111AEAu, 0x88F4BB1CA6BCF585u},
+	{0xEC1E4A7DB69561A5u, 0x2B31E9E3D06C32E6u},
+	{0x9392EE8E921D5D07u, 0x3AFF322E62439FD0u},
+	{0xB877AA3236A4B449u, 0x09BEFEB9FAD487C3u},
+	{0xE69594BEC44DE15Bu, 0x4C2EBE687989A9B4u},
+	{0x901D7CF73AB0ACD9u, 0x0F9D37014BF60A11u},
+	{0xB424DC35095CD80Fu, 0x538484C19EF38C95u},
+	{0xE12E13424BB40E13u, 0x2865A5F206B06FBAu},
+	{0x8CBCCC096F5088CBu, 0xF93F87B7442E45D4u},
+	{0xAFEBFF0BCB24AAFEu, 0xF78F69A51539D749u},
+	{0xDBE6FECEBDEDD5BEu, 0xB573440E5A884D1Cu},
+	{0x89705F4136B4A597u, 0x31680A88F8953031u},
+	{0xABCC77118461CEFCu, 0xFDC20D2B36BA7C3Eu},
+	{0xD6BF94D5E57A42BCu, 0x3D32907604691B4Du},
+	{0x8637BD05AF6C69B5u, 0xA63F9A49C2C1B110u},
+	{0xA7C5AC471B478423u, 0x0FCF80DC33721D54u},
+	{0xD1B71758E219652Bu, 0xD3C36113404EA4A9u},
+	{0x83126E978D4FDF3Bu, 0x645A1CAC083126EAu},
+	{0xA3D70A3D70A3D70Au, 0x3D70A3D70A3D70A4u},
+	{0xCCCCCCCCCCCCCCCCu, 0xCCCCCCCCCCCCCCCDu},
+	{0x8000000000000000u, 0x0000000000000000u},
+	{0xA000000000000000u, 0x0000000000000000u},
+	{0xC800000000000000u, 0x0000000000000000u},
+	{0xFA00000000000000u, 0x0000000000000000u},
+	{0x9C40000000000000u, 0x0000000000000000u},
+	{0xC350000000000000u, 0x0000000000000000u},
+	{0xF424000000000000u, 0x0000000000000000u},
+	{0x9896800000000000u, 0x0000000000000000u},
+	{0xBEBC200000000000u, 0x0000000000000000u},
+	{0xEE6B280000000000u, 0x0000000000000000u},
+	{0x9502F90000000000u, 0x0000000000000000u},
+	{0xBA43B74000000000u, 0x0000000000000000u},
+	{0xE8D4A51000000000u, 0x0000000000000000u},
+	{0x9184E72A00000000u, 0x0000000000000000u},
+	{0xB5E620F480000000u, 0x0000000000000000u},
+	{0xE35FA931A0000000u, 0x0000000000000000u},
+	{0x8E1BC9BF04000000u, 0x0000000000000000u},
+	{0xB1A2BC2EC5000000u, 0x0000000000000000u},
+	{0xDE0B6B3A76400000u, 0x0000000000000000u},
+	{0x8AC7230489E80000u, 0x0000000000000000u},
+	{0xAD78EBC5AC620000u, 0x0000000000000000u},
+	{0xD8D726B7177A8000u, 0x0000000000000000u},
+	{0x878678326EAC9000u, 0x0000000000000000u},
+	{0xA968163F0A57B400u, 0x0000000000000000u},
+	{0xD3C21BCECCEDA100u, 0x0000000000000000u},
+	{0x84595161401484A0u, 0x0000000000000000u},
+	{0xA56FA5B99019A5C8u, 0x0000000000000000u},
+	{0xCECB8F27F4200F3Au, 0x0000000000000000u},
+	{0x813F3978F8940984u, 0x4000000000000000u},
+	{0xA18F07D736B90BE5u, 0x5000000000000000u},
+	{0xC9F2C9CD04674EDEu, 0xA400000000000000u},
+	{0xFC6F7C4045812296u, 0x4D00000000000000u},
+	{0x9DC5ADA82B70B59Du, 0xF020000000000000u},
+	{0xC5371912364CE305u, 0x6C28000000000000u},
+	{0xF684DF56C3E01BC6u, 0xC732000000000000u},
+	{0x9A130B963A6C115Cu, 0x3C7F400000000000u},
+	{0xC097CE7BC90715B3u, 0x4B9F100000000000u},
+	{0xF0BDC21ABB48DB20u, 0x1E86D40000000000u},
+	{0x96769950B50D88F4u, 0x1314448000000000u},
+	{0xBC143FA4E250EB31u, 0x17D955A000000000u},
+	{0xEB194F8E1AE525FDu, 0x5DCFAB0800000000u},
+	{0x92EFD1B8D0CF37BEu, 0x5AA1CAE500000000u},
+	{0xB7ABC627050305ADu, 0xF14A3D9E40000000u},
+	{0xE596B7B0C643C719u, 0x6D9CCD05D0000000u},
+	{0x8F7E32CE7BEA5C6Fu, 0xE4820023A2000000u},
+	{0xB35DBF821AE4F38Bu, 0xDDA2802C8A800000u},
+	{0xE0352F62A19E306Eu, 0xD50B2037AD200000u},
+	{0x8C213D9DA502DE45u, 0x4526F422CC340000u},
+	{0xAF298D050E4395D6u, 0x9670B12B7F410000u},
+	{0xDAF3F04651D47B4Cu, 0x3C0CDD765F114000u},
+	{0x88D8762BF324CD0Fu, 0xA5880A69FB6AC800u},
+	{0xAB0E93B6EFEE0053u, 0x8EEA0D047A457A00u},
+	{0xD5D238A4ABE98068u, 0x72A4904598D6D880u},
+	{0x85A36366EB71F041u, 0x47A6DA2B7F864750u},
+	{0xA70C3C40A64E6C51u, 0x999090B65F67D924u},
+	{0xD0CF4B50CFE20765u, 0xFFF4B4E3F741CF6Du},
+	{0x82818F1281ED449Fu, 0xBFF8F10E7A8921A4u},
+	{0xA321F2D7226895C7u, 0xAFF72D52192B6A0Du},
+	{0xCBEA6F8CEB02BB39u, 0x9BF4F8A69F764490u},
+	{0xFEE50B7025C36A08u, 0x02F236D04753D5B4u},
+	{0x9F4F2726179A2245u, 0x01D762422C946590u},
+	{0xC722F0EF9D80AAD6u, 0x424D3AD2B7B97EF5u},
+	{0xF8EBAD2B84E0D58Bu, 0xD2E0898765A7DEB2u},
+	{0x9B934C3B330C8577u, 0x63CC55F49F88EB2Fu},
+	{0xC2781F49FFCFA6D5u, 0x3CBF6B71C76B25FBu},
+	{0xF316271C7FC3908Au, 0x8BEF464E3945EF7Au},
+	{0x97EDD871CFDA3A56u, 0x97758BF0E3CBB5ACu},
+	{0xBDE94E8E43D0C8ECu, 0x3D52EEED1CBEA317u},
+	{0xED63A231D4C4FB27u, 0x4CA7AAA863EE4BDDu},
+	{0x945E455F24FB1CF8u, 0x8FE8CAA93E74EF6Au},
+	{0xB975D6B6EE39E436u, 0xB3E2FD538E122B44u},
+	{0xE7D34C64A9C85D44u, 0x60DBBCA87196B616u},
+	{0x90E40FBEEA1D3A4Au, 0xBC8955E946FE31CDu},
+	{0xB51D13AEA4A488DDu, 0x6BABAB6398BDBE41u},
+	{0xE264589A4DCDAB14u, 0xC696963C7EED2DD1u},
+	{0x8D7EB76070A08AECu, 0xFC1E1DE5CF543CA2u},
+	{0xB0DE65388CC8ADA8u, 0x3B25A55F43294BCBu},
+	{0xDD15FE86AFFAD912u, 0x49EF0EB713F39EBEu},
+	{0x8A2DBF142DFCC7ABu, 0x6E3569326C784337u},
+	{0xACB92ED9397BF996u, 0x49C2C37F07965404u},
+	{0xD7E77A8F87DAF7FBu, 0xDC33745EC97BE906u},
+	{0x86F0AC99B4E8DAFDu, 0x69A028BB3DED71A3u},
+	{0xA8ACD7C0222311BCu, 0xC40832EA0D68CE0Cu},
+	{0xD2D80DB02AABD62Bu, 0xF50A3FA490C30190u},
+	{0x83C7088E1AAB65DBu, 0x792667C6DA79E0FAu},
+	{0xA4B8CAB1A1563F52u, 0x577001B891185938u},
+	{0xCDE6FD5E09ABCF26u, 0xED4C0226B55E6F86u},
+	{0x80B05E5AC60B6178u, 0x544F8158315B05B4u},
+	{0xA0DC75F1778E39D6u, 0x696361AE3DB1C721u},
+	{0xC913936DD571C84Cu, 0x03BC3A19CD1E38E9u},
+	{0xFB5878494ACE3A5Fu, 0x04AB48A04065C723u},
+	{0x9D174B2DCEC0E47Bu, 0x62EB0D64283F9C76u},
+	{0xC45D1DF942711D9Au, 0x3BA5D0BD324F8394u},
+	{0xF5746577930D6500u, 0xCA8F44EC7EE36479u},
+	{0x9968BF6ABBE85F20u, 0x7E998B13CF4E1ECBu},
+	{0xBFC2EF456AE276E8u, 0x9E3FEDD8C321A67Eu},
+	{0xEFB3AB16C59B14A2u, 0xC5CFE94EF3EA101Eu},
+	{0x95D04AEE3B80ECE5u, 0xBBA1F1D158724A12u},
+	{0xBB445DA9CA61281Fu, 0x2A8A6E45AE8EDC97u},
+	{0xEA1575143CF97226u, 0xF52D09D71A3293BDu},
+	{0x924D692CA61BE758u, 0x593C2626705F9C56u},
+	{0xB6E0C377CFA2E12Eu, 0x6F8B2FB00C77836Cu},
+	{0xE498F455C38B997Au, 0x0B6DFB9C0F956447u},
+	{0x8EDF98B59A373FECu, 0x4724BD4189BD5EACu},
+	{0xB2977EE300C50FE7u, 0x58EDEC91EC2CB657u},
+	{0xDF3D5E9BC0F653E1u, 0x2F2967B66737E3EDu},
+	{0x8B865B215899F46Cu, 0xBD79E0D20082EE74u},
+	{0xAE67F1E9AEC07187u, 0xECD8590680A3AA11u},
+	{0xDA01EE641A708DE9u, 0xE80E6F4820CC9495u},
+	{0x884134FE908658B2u, 0x3109058D147FDCDDu},
+	{0xAA51823E34A7EEDEu, 0xBD4B46F0599FD415u},
+	{0xD4E5E2CDC1D1EA96u, 0x6C9E18AC7007C91Au},
+	{0x850FADC09923329Eu, 0x03E2CF6BC604DDB0u},
+	{0xA6539930BF6BFF45u, 0x84DB8346B786151Cu},
+	{0xCFE87F7CEF46FF16u, 0xE612641865679A63u},
+	{0x81F14FAE158C5F6Eu, 0x4FCB7E8F3F60C07Eu},
+	{0xA26DA3999AEF7749u, 0xE3BE5E330F38F09Du},
+	{0xCB090C8001AB551Cu, 0x5CADF5BFD3072CC5u},
+	{0xFDCB4FA002162A63u, 0x73D9732FC7C8F7F6u},
+	{0x9E9F11C4014DDA7Eu, 0x2867E7FDDCDD9AFAu},
+	{0xC646D63501A1511Du, 0xB281E1FD541501B8u},
+	{0xF7D88BC24209A565u, 0x1F225A7CA91A4226u},
+	{0x9AE757596946075Fu, 0x3375788DE9B06958u},
+	{0xC1A12D2FC3978937u, 0x0052D6B1641C83AEu},
+	{0xF209787BB47D6B84u, 0xC0678C5DBD23A49Au},
+	{0x9745EB4D50CE6332u, 0xF840B7BA963646E0u},
+	{0xBD176620A501FBFFu, 0xB650E5A93BC3D898u},
+	{0xEC5D3FA8CE427AFFu, 0xA3E51F138AB4CEBEu},
+	{0x93BA47C980E98CDFu, 0xC66F336C36B10137u},
+	{0xB8A8D9BBE123F017u, 0xB80B0047445D4184u},
+	{0xE6D3102AD96CEC1Du, 0xA60DC059157491E5u},
+	{0x9043EA1AC7E41392u, 0x87C89837AD68DB2Fu},
+	{0xB454E4A179DD1877u, 0x29BABE4598C311FBu},
+	{0xE16A1DC9D8545E94u, 0xF4296DD6FEF3D67Au},
+	{0x8CE2529E2734BB1Du, 0x1899E4A65F58660Cu},
+	{0xB01AE745B101E9E4u, 0x5EC05DCFF72E7F8Fu},
+	{0xDC21A1171D42645Du, 0x76707543F4FA1F73u},
+	{0x899504AE72497EBAu, 0x6A06494A791C53A8u},
+	{0xABFA45DA0EDBDE69u, 0x0487DB9D17636892u},
+	{0xD6F8D7509292D603u, 0x45A9D2845D3C42B6u},
+	{0x865B86925B9BC5C2u, 0x0B8A2392BA45A9B2u},
+	{0xA7F26836F282B732u, 0x8E6CAC7768D7141Eu},
+	{0xD1EF0244AF2364FFu, 0x3207D795430CD926u},
+	{0x8335616AED761F1Fu, 0x7F44E6BD49E807B8u},
+	{0xA402B9C5A8D3A6E7u, 0x5F16206C9C6209A6u},
+	{0xCD036837130890A1u, 0x36DBA887C37A8C0Fu},
+	{0x802221226BE55A64u, 0xC2494954DA2C9789u},
+	{0xA02AA96B06DEB0FDu, 0xF2DB9BAA10B7BD6Cu},
+	{0xC83553C5C8965D3Du, 0x6F92829494E5ACC7u},
+	{0xFA42A8B73ABBF48Cu, 0xCB772339BA1F17F9u},
+	{0x9C69A97284B578D7u, 0xFF2A760414536EFBu},
+	{0xC38413CF25E2D70Du, 0xFEF5138519684ABAu},
+	{0xF46518C2EF5B8CD1u, 0x7EB258665FC25D69u},
+	{0x98BF2F79D5993802u, 0xEF2F773FFBD97A61u},
+	{0xBEEEFB584AFF8603u, 0xAAFB550FFACFD8FAu},
+	{0xEEAABA2E5DBF6784u, 0x95BA2A53F983CF38u},
+	{0x952AB45CFA97A0B2u, 0xDD945A747BF26183u},
+	{0xBA756174393D88DFu, 0x94F971119AEEF9E4u},
+	{0xE912B9D1478CEB17u, 0x7A37CD5601AAB85Du},
+	{0x91ABB422CCB812EEu, 0xAC62E055C10AB33Au},
+	{0xB616A12B7FE617AAu, 0x577B986B314D6009u},
+	{0xE39C49765FDF9D94u, 0xED5A7E85FDA0B80Bu},
+	{0x8E41ADE9FBEBC27Du, 0x14588F13BE847307u},
+	{0xB1D219647AE6B31Cu, 0x596EB2D8AE258FC8u},
+	{0xDE469FBD99A05FE3u, 0x6FCA5F8ED9AEF3BBu},
+	{0x8AEC23D680043BEEu, 0x25DE7BB9480D5854u},
+	{0xADA72CCC20054AE9u, 0xAF561AA79A10AE6Au},
+	{0xD910F7FF28069DA4u, 0x1B2BA1518094DA04u},
+	{0x87AA9AFF79042286u, 0x90FB44D2F05D0842u},
+	{0xA99541BF57452B28u, 0x353A1607AC744A53u},
+	{0xD3FA922F2D1675F2u, 0x42889B8997915CE8u},
+	{0x847C9B5D7C2E09B7u, 0x69956135FEBADA11u},
+	{0xA59BC234DB398C25u, 0x43FAB9837E699095u},
+	{0xCF02B2C21207EF2Eu, 0x94F967E45E03F4BBu},
+	{0x8161AFB94B44F57Du, 0x1D1BE0EEBAC278F5u},
+	{0xA1BA1BA79E1632DCu, 0x6462D92A69731732u},
+	{0xCA28A291859BBF93u, 0x7D7B8F7503CFDCFEu},
+	{0xFCB2CB35E702AF78u, 0x5CDA735244C3D43Eu},
+	{0x9DEFBF01B061ADABu, 0x3A0888136AFA64A7u},
+	{0xC56BAEC21C7A1916u, 0x088AAA1845B8FDD0u},
+	{0xF6C69A72A3989F5Bu, 0x8AAD549E57273D45u},
+	{0x9A3C2087A63F6399u, 0x36AC54E2F678864Bu},
+	{0xC0CB28A98FCF3C7Fu, 0x84576A1BB416A7DDu},
+	{0xF0FDF2D3F3C30B9Fu, 0x656D44A2A11C51D5u},
+	{0x969EB7C47859E743u, 0x9F644AE5A4B1B325u},
+	{0xBC4665B596706114u, 0x873D5D9F0DDE1FEEu},
+	{0xEB57FF22FC0C7959u, 0xA90CB506D155A7EAu},
+	{0x9316FF75DD87CBD8u, 0x09A7F12442D588F2u},
+	{0xB7DCBF5354E9BECEu, 0x0C11ED6D538AEB2Fu},
+	{0xE5D3EF282A242E81u, 0x8F1668C8A86DA5FAu},
+	{0x8FA475791A569D10u, 0xF96E017D694487BCu},
+	{0xB38D92D760EC4455u, 0x37C981DCC395A9ACu},
+	{0xE070F78D3927556Au, 0x85BBE253F47B1417u},
+	{0x8C469AB843B89562u, 0x93956D7478CCEC8Eu},
+	{0xAF58416654A6BABBu, 0x387AC8D1970027B2u},
+	{0xDB2E51BFE9D0696Au, 0x06997B05FCC0319Eu},
+	{0x88FCF317F22241E2u, 0x441FECE3BDF81F03u},
+	{0xAB3C2FDDEEAAD25Au, 0xD527E81CAD7626C3u},
+	{0xD60B3BD56A5586F1u, 0x8A71E223D8D3B074u},
+	{0x85C7056562757456u, 0xF6872D5667844E49u},
+	{0xA738C6BEBB12D16Cu, 0xB428F8AC016561DBu},
+	{0xD106F86E69D785C7u, 0xE13336D701BEBA52u},
+	{0x82A45B450226B39Cu, 0xECC0024661173473u},
+	{0xA34D721642B06084u, 0x27F002D7F95D0190u},
+	{0xCC20CE9BD35C78A5u, 0x31EC038DF7B441F4u},
+	{0xFF290242C83396CEu, 0x7E67047175A15271u},
+	{0x9F79A169BD203E41u, 0x0F0062C6E984D386u},
+	{0xC75809C42C684DD1u, 0x52C07B78A3E60868u},
+	{0xF92E0C3537826145u, 0xA7709A56CCDF8A82u},
+	{0x9BBCC7A142B17CCBu, 0x88A66076400BB691u},
+	{0xC2ABF989935DDBFEu, 0x6ACFF893D00EA435u},
+	{0xF356F7EBF83552FEu, 0x0583F6B8C4124D43u},
+	{0x98165AF37B2153DEu, 0xC3727A337A8B704Au},
+	{0xBE1BF1B059E9A8D6u, 0x744F18C0592E4C5Cu},
+	{0xEDA2EE1C7064130Cu, 0x1162DEF06F79DF73u},
+	{0x9485D4D1C63E8BE7u, 0x8ADDCB5645AC2BA8u},
+	{0xB9A74A0637CE2EE1u, 0x6D953E2BD7173692u},
+	{0xE8111C87C5C1BA99u, 0xC8FA8DB6CCDD0437u},
+	{0x910AB1D4DB9914A0u, 0x1D9C9892400A22A2u},
+	{0xB54D5E4A127F59C8u, 0x2503BEB6D00CAB4Bu},
+	{0xE2A0B5DC971F303Au, 0x2E44AE64840FD61Du},
+	{0x8DA471A9DE737E24u, 0x5CEAECFED289E5D2u},
+	{0xB10D8E1456105DADu, 0x7425A83E872C5F47u},
+	{0xDD50F1996B947518u, 0xD12F124E28F77719u},
+	{0x8A5296FFE33CC92Fu, 0x82BD6B70D99AAA6Fu},
+	{0xACE73CBFDC0BFB7Bu, 0x636CC64D1001550Bu},
+	{0xD8210BEFD30EFA5Au, 0x3C47F7E05401AA4Eu},
+	{0x8714A775E3E95C78u, 0x65ACFAEC34810A71u},
+	{0xA8D9D1535CE3B396u, 0x7F1839A741A14D0Du},
+	{0xD31045A8341CA07Cu, 0x1EDE48111209A050u},
+	{0x83EA2B892091E44Du, 0x934AED0AAB460432u},
+	{0xA4E4B66B68B65D60u, 0xF81DA84D5617853Fu},
+	{0xCE1DE40642E3F4B9u, 0x36251260AB9D668Eu},
+	{0x80D2AE83E9CE78F3u, 0xC1D72B7C6B426019u},
+	{0xA1075A24E4421730u, 0xB24CF65B8612F81Fu},
+	{0xC94930AE1D529CFCu, 0xDEE033F26797B627u},
+	{0xFB9B7CD9A4A7443Cu, 0x169840EF017DA3B1u},
+	{0x9D412E0806E88AA5u, 0x8E1F289560EE864Eu},
+	{0xC491798A08A2AD4Eu, 0xF1A6F2BAB92A27E2u},
+	{0xF5B5D7EC8ACB58A2u, 0xAE10AF696774B1DBu},
+	{0x9991A6F3D6BF1765u, 0xACCA6DA1E0A8EF29u},
+	{0xBFF610B0CC6EDD3Fu, 0x17FD090A58D32AF3u},
+	{0xEFF394DCFF8A948Eu, 0xDDFC4B4CEF07F5B0u},
+	{0x95F83D0A1FB69CD9u, 0x4ABDAF101564F98Eu},
+	{0xBB764C4CA7A4440Fu, 0x9D6D1AD41ABE37F1u},
+	{0xEA53DF5FD18D5513u, 0x84C86189216DC5EDu},
+	{0x92746B9BE2F8552Cu, 0x32FD3CF5B4E49BB4u},
+	{0xB7118682DBB66A77u, 0x3FBC8C33221DC2A1u},
+	{0xE4D5E82392A40515u, 0x0FABAF3FEAA5334Au},
+	{0x8F05B1163BA6832Du, 0x29CB4D87F2A7400Eu},
+	{0xB2C71D5BCA9023F8u, 0x743E20E9EF511012u},
+	{0xDF78E4B2BD342CF6u, 0x914DA9246B255416u},
+	{0x8BAB8EEFB6409C1Au, 0x1AD089B6C2F7548Eu},
+	{0xAE9672ABA3D0C320u, 0xA184AC2473B529B1u},
+	{0xDA3C0F568CC4F3E8u, 0xC9E5D72D90A2741Eu},
+	{0x8865899617FB1871u, 0x7E2FA67C7A658892u},
+	{0xAA7EEBFB9DF9DE8Du, 0xDDBB901B98FEEAB7u},
+	{0xD51EA6FA85785631u, 0x552A74227F3EA565u},
+	{0x8533285C936B35DEu, 0xD53A88958F87275Fu},
+	{0xA67FF273B8460356u, 0x8A892ABAF368F137u},
+	{0xD01FEF10A657842Cu, 0x2D2B7569B0432D85u},
+	{0x8213F56A67F6B29Bu, 0x9C3B29620E29FC73u},
+	{0xA298F2C501F45F42u, 0x8349F3BA91B47B8Fu},
+	{0xCB3F2F7642717713u, 0x241C70A936219A73u},
+	{0xFE0EFB53D30DD4D7u, 0xED238CD383AA0110u},
+	{0x9EC95D1463E8A506u, 0xF4363804324A40AAu},
+	{0xC67BB4597CE2CE48u, 0xB143C6053EDCD0D5u},
+	{0xF81AA16FDC1B81DAu, 0xDD94B7868E94050Au},
+	{0x9B10A4E5E9913128u, 0xCA7CF2B4191C8326u},
+	{0xC1D4CE1F63F57D72u, 0xFD1C2F611F63A3F0u},
+	{0xF24A01A73CF2DCCFu, 0xBC633B39673C8CECu},
+	{0x976E41088617CA01u, 0xD5BE0503E085D813u},
+	{0xBD49D14AA79DBC82u, 0x4B2D8644D8A74E18u},
+	{0xEC9C459D51852BA2u, 0xDDF8E7D60ED1219Eu},
+	{0x93E1AB8252F33B45u, 0xCABB90E5C942B503u},
+	{0xB8DA1662E7B00A17u, 0x3D6A751F3B936243u},
+	{0xE7109BFBA19C0C9Du, 0x0CC512670A783AD4u},
+	{0x906A617D450187E2u, 0x27FB2B80668B24C5u},
+	{0xB484F9DC9641E9DAu, 0xB1F9F660802DEDF6u},
+	{0xE1A63853BBD26451u, 0x5E7873F8A0396973u},
+	{0x8D07E33455637EB2u, 0xDB0B487B6423E1E8u},
+	{0xB049DC016ABC5E5Fu, 0x91CE1A9A3D2CDA62u},
+	{0xDC5C5301C56B75F7u, 0x7641A140CC7810FBu},
+	{0x89B9B3E11B6329BAu, 0xA9E904C87FCB0A9Du},
+	{0xAC2820D9623BF429u, 0x546345FA9FBDCD44u},
+	{0xD732290FBACAF133u, 0xA97C177947AD4095u},
+	{0x867F59A9D4BED6C0u, 0x49ED8EABCCCC485Du},
+	{0xA81F301449EE8C70u, 0x5C68F256BFFF5A74u},
+	{0xD226FC195C6A2F8Cu, 0x73832EEC6FFF3111u},
+	{0x83585D8FD9C25DB7u, 0xC831FD53C5FF7EABu},
+	{0xA42E74F3D032F525u, 0xBA3E7CA8B77F5E55u},
+	{0xCD3A1230C43FB26Fu, 0x28CE1BD2E55F35EBu},
+	{0x80444B5E7AA7CF85u, 0x7980D163CF5B81B3u},
+	{0xA0555E361951C366u, 0xD7E105BCC332621Fu},
+	{0xC86AB5C39FA63440u, 0x8DD9472BF3FEFAA7u},
+	{0xFA856334878FC150u, 0xB14F98F6F0FEB951u},
+	{0x9C935E00D4B9D8D2u, 0x6ED1BF9A569F33D3u},
+	{0xC3B8358109E84F07u, 0x0A862F80EC4700C8u},
+	{0xF4A642E14C6262C8u, 0xCD27BB612758C0FAu},
+	{0x98E7E9CCCFBD7DBDu, 0x8038D51CB897789Cu},
+	{0xBF21E44003ACDD2Cu, 0xE0470A63E6BD56C3u},
+	{0xEEEA5D5004981478u, 0x1858CCFCE06CAC74u},
+	{0x95527A5202DF0CCBu, 0x0F37801E0C43EBC8u},
+	{0xBAA718E68396CFFDu, 0xD30560258F54E6BAu},
+	{0xE950DF20247C83FDu, 0x47C6B82EF32A2069u},
+	{0x91D28B7416CDD27Eu, 0x4CDC331D57FA5441u},
+	{0xB6472E511C81471Du, 0xE0133FE4ADF8E952u},
+	{0xE3D8F9E563A198E5u, 0x58180FDDD97723A6u},
+	{0x8E679C2F5E44FF8Fu, 0x570F09EAA7EA7648u}
+};
+
+static const double lynx_pow10_exact[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+//64位乘法，返回乘积的低64位，高64位存入*hi
+static uint64_t lynx_umul128(uint64_t a, uint64_t b, uint64_t* hi)
 {
-	//检验数字是否符合JSON规范
-	//number = [ "-" ] int [ frac ] [ exp ]
-	//int = "0" / digit1-9 *digit
-	//frac = "." 1*digit
-	//exp = ("e" / "E") ["-" / "+"] 1*digit
-	const char *p = c->json;
-	if (*p == '-') ++p;
-	if (ISDIGIT(*p)) {
-		if (ISDIGIT1TO9(*p)) for (++p; ISDIGIT(*p); ++p);
-		else ++p;
-	} else {
-		return LYNX_PARSE_INVALID_VALUE;
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = (unsigned __int128)a * b;
+	*hi = (uint64_t)(r >> 64);
+	return (uint64_t)r;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+	return _umul128(a, b, hi);
+#else
+	uint64_t a0 = (uint32_t)a, a1 = a >> 32, b0 = (uint32_t)b, b1 = b >> 32;
+	uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+	*hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+	return (mid << 32) | (uint32_t)p00;
+#endif
+}
+
+//返回最高位的1之前0的个数，x不能为0
+static unsigned lynx_clz64(uint64_t x)
+{
+	assert(x != 0);
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_clzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+	unsigned long r;
+	_BitScanReverse64(&r, x);
+	return 63 - (unsigned)r;
+#else
+	unsigned n = 0;
+	while (!(x & ((uint64_t)1 << 63))) { x <<= 1; ++n; }
+	return n;
+#endif
+}
+
+#define LYNX_DOUBLE_INF_BITS ((uint64_t)0x7FF << 52)
+
+//Eisel-Lemire算法：计算w * 10^q（w不为0）正确舍入后的double的位表示（不含符号）
+static uint64_t lynx_eisel_lemire(uint64_t w, int q)
+{
+	const uint64_t* pow5;
+	uint64_t lo, hi, lo2, hi2, mantissa;
+	unsigned lz, upperbit, shift;
+	int power2;
+	if (q < LYNX_POW10_MIN) return 0;
+	if (q > LYNX_POW10_MAX) return LYNX_DOUBLE_INF_BITS;
+	lz = lynx_clz64(w);
+	w <<= lz;
+	pow5 = lynx_pow5_128[q - LYNX_POW10_MIN];
+	lo = lynx_umul128(w, pow5[0], &hi);
+	//高位中决定舍入的9位全为1时，低位的进位可能影响结果，需要乘上128位近似值的低64位
+	if ((hi & 0x1FF) == 0x1FF) {
+		lynx_umul128(w, pow5[1], &hi2);
+		lo2 = lo + hi2;
+		if (lo2 < lo) ++hi;
+		lo = lo2;
 	}
-	if (*p == '.') {
-		++p;
-		if (ISDIGIT(*p)) {
-			for (++p; ISDIGIT(*p); ++p);
-		} else {
-			return LYNX_PARSE_INVALID_VALUE;
+	upperbit = (unsigned)(hi >> 63);
+	shift = upperbit + 64 - 52 - 3;
+	mantissa = hi >> shift;
+	//floor(log2(10^q)) + 63，加上规格化的位移和指数偏移
+	power2 = (int)((((152170 + 65536) * q) >> 16) + 63) + (int)upperbit - (int)lz + 1023;
+	if (power2 <= 0) {
+		//非规格化数
+		if (-power2 + 1 >= 64) return 0;
+		mantissa >>= -power2 + 1;
+		mantissa += mantissa & 1;
+		mantissa >>= 1;
+		//舍入后可能进位成为最小的规格化数，此时指数字段为1，正好是mantissa的第52位
+		return mantissa;
+	}
+	//恰好位于两个double中间时向偶数舍入（只可能出现在这个范围的q中）
+	if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == hi) {
+		mantissa &= ~(uint64_t)1;
+	}
+	mantissa += mantissa & 1;
+	mantissa >>= 1;
+	if (mantissa >= ((uint64_t)2 << 52)) {
+		mantissa = (uint64_t)1 << 52;
+		++power2;
+	}
+	mantissa &= ~((uint64_t)1 << 52);
+	if (power2 >= 0x7FF) return LYNX_DOUBLE_INF_BITS;
+	return ((uint64_t)power2 << 52) | mantissa;
+}
+
+//用于精确回退的大整数，32位一节，低位在前
+#define LYNX_BIGINT_LIMBS 160
+typedef struct {
+	uint32_t d[LYNX_BIGINT_LIMBS];
+	size_t n;
+} lynx_bigint;
+
+static void lynx_bigint_muladd(lynx_bigint* a, uint32_t mul, uint32_t add)
+{
+	uint64_t carry = add;
+	for (size_t i = 0; i < a->n; ++i) {
+		carry += (uint64_t)a->d[i] * mul;
+		a->d[i] = (uint32_t)carry;
+		carry >>= 32;
+	}
+	if (carry) {
+		assert(a->n < LYNX_BIGINT_LIMBS);
+		a->d[a->n++] = (uint32_t)carry;
+	}
+}
+
+static void lynx_bigint_mulpow5(lynx_bigint* a, int e)
+{
+	//5^13是32位能表示的最大的5的幂
+	for (; e >= 13; e -= 13) lynx_bigint_muladd(a, 1220703125u, 0);
+	if (e > 0) {
+		uint32_t m = 1;
+		while (e-- > 0) m *= 5;
+		lynx_bigint_muladd(a, m, 0);
+	}
+}
+
+static void lynx_bigint_shl(lynx_bigint* a, int bits)
+{
+	size_t limbs = (size_t)bits / 32, i;
+	unsigned r = (unsigned)bits % 32;
+	if (a->n == 0) return;
+	assert(a->n + limbs + 1 <= LYNX_BIGINT_LIMBS);
+	if (r) {
+		a->d[a->n] = 0;
+		for (i = a->n; i > 0; --i)
+			a->d[i] = (a->d[i] << r) | (a->d[i - 1] >> (32 - r));
+		a->d[0] <<= r;
+		if (a->d[a->n]) ++a->n;
+	}
+	if (limbs) {
+		memmove(a->d + limbs, a->d, a->n * sizeof(uint32_t));
+		memset(a->d, 0, limbs * sizeof(uint32_t));
+		a->n += limbs;
+	}
+}
+
+static int lynx_bigint_cmp(const lynx_bigint* a, const lynx_bigint* b)
+{
+	size_t i;
+	if (a->n != b->n) return a->n < b->n ? -1 : 1;
+	for (i = a->n; i > 0; --i) {
+		if (a->d[i - 1] != b->d[i - 1]) return a->d[i - 1] < b->d[i - 1] ? -1 : 1;
+	}
+	return 0;
+}
+
+#define LYNX_BIGINT_MAX_DIGITS 780	//超过这个数目的有效数字不会影响舍入结果，只需记录是否非零
+
+//精确比较：digits指向数字的整数部分，exp为显式的指数部分，b是截断尾数得到的候选值
+//返回正确舍入后的结果，只可能是b或者b的下一个double
+static uint64_t lynx_decimal_round(const char* digits, const char* end, int exp, uint64_t b)
+{
+	lynx_bigint lhs, rhs;
+	const char* p = digits;
+	int kept = 0, frac = 0, sticky = 0, e2, k;
+	uint64_t m;
+	uint32_t chunk = 0, scale = 1;
+	lhs.n = 0;
+	//收集有效数字，每9位一组乘进大整数
+	for (; p != end; ++p) {
+		if (*p == '.') { frac = 1; continue; }
+		if (!ISDIGIT(*p)) break;
+		if (frac) --exp;
+		if (kept == 0 && *p == '0') continue;	//前导0
+		if (kept == LYNX_BIGINT_MAX_DIGITS) {
+			//舍去的整数位使指数加1，舍去的小数位则抵消上面的减1
+			if (*p != '0') sticky = 1;
+			++exp;
+			continue;
+		}
+		chunk = chunk * 10 + (uint32_t)(*p - '0');
+		scale *= 10;
+		++kept;
+		if (scale == 1000000000u) {
+			lynx_bigint_muladd(&lhs, scale, chunk);
+			chunk = 0; scale = 1;
+		}
+	}
+	if (scale > 1) lynx_bigint_muladd(&lhs, scale, chunk);
+	if (sticky) {
+		//舍去的部分非零：在末尾补一位1，保证不会恰好落在中点上
+		lynx_bigint_muladd(&lhs, 10, 1);
+		--exp;
+	}
+	//候选值b = m * 2^e2，中点为(2m + 1) * 2^(e2 - 1)
+	if ((b >> 52) == 0) {
+		m = b;
+		e2 = -1074;
+	} else {
+		m = (b & (((uint64_t)1 << 52) - 1)) | ((uint64_t)1 << 52);
+		e2 = (int)(b >> 52) - 1075;
+	}
+	m = 2 * m + 1;
+	rhs.d[0] = (uint32_t)m;
+	rhs.d[1] = (uint32_t)(m >> 32);
+	rhs.n = rhs.d[1] ? 2 : 1;
+	//lhs * 5^exp * 2^exp 与 rhs * 2^(e2-1)比较，5的幂乘到对应的一侧，2的幂只在一侧保留差值
+	if (exp >= 0) lynx_bigint_mulpow5(&lhs, exp);
+	else lynx_bigint_mulpow5(&rhs, -exp);
+	k = exp - (e2 - 1);
+	if (k > 0) lynx_bigint_shl(&lhs, k);
+	else if (k < 0) lynx_bigint_shl(&rhs, -k);
+	k = lynx_bigint_cmp(&lhs, &rhs);
+	if (k > 0 || (k == 0 && (b & 1))) return b + 1;
+	return b;
+}
+
+//检验数字是否符合JSON规范，同时累积尾数，然后转换为double
+#define AT(p) ((p) != end ? *(p) : '\0')	//读取p处的字符，到达结尾时视为'\0'
+static int lynx_parse_number(lynx_context* c, lynx_value* v)
+{
+	//number = [ "-" ] int [ frac ] [ exp ]
+	//int = "0" / digit1-9 *digit
+	//frac = "." 1*digit
+	//exp = ("e" / "E") ["-" / "+"] 1*digit
+	const char *p = c->json, *end = c->end, *digits, *int_end;
+	uint64_t m = 0, bits;	//前19位有效数字
+	int neg = 0, nd = 0, e10 = 0, exp = 0, eneg = 0, truncated = 0;
+	double d;
+	if (AT(p) == '-') { neg = 1; ++p; }
+	digits = p;
+	if (ISDIGIT1TO9(AT(p))) {
+		for (; ISDIGIT(AT(p)); ++p) {
+			if (nd < 19) { m = m * 10 + (unsigned)(*p - '0'); ++nd; }
+			else { ++e10; if (*p != '0') truncated = 1; }
+		}
+	} else
+	if (AT(p) == '0') {
+		++p;
+	} else {
+		return LYNX_PARSE_INVALID_VALUE;
+	}
+	int_end = p;
+	if (AT(p) == '.') {
+		++p;
+		if (!ISDIGIT(AT(p))) return LYNX_PARSE_INVALID_VALUE;
+		for (; ISDIGIT(AT(p)); ++p) {
+			if (m == 0 && *p == '0') { --e10; continue; }	//小数部分的前导0不是有效数字
+			if (nd < 19) { m = m * 10 + (unsigned)(*p - '0'); ++nd; --e10; }
+			else if (*p != '0') truncated = 1;
 		}
 	}
-	if (*p == 'e' || *p == 'E') {
+	if (AT(p) == 'e' || AT(p) == 'E') {
 		++p;
-		if (*p == '+' || *p == '-') ++p;
-		if (ISDIGIT(*p)) for (++p; ISDIGIT(*p); ++p);
-		else return LYNX_PARSE_INVALID_VALUE;
-	}
-	errno = 0;
-	v->u.n = strtod(c->json, NULL);
-	if (errno == ERANGE && (v->u.n == HUGE_VAL || v->u.n == -HUGE_VAL))
-		return LYNX_PARSE_NUMBER_TOO_BIG;
+		if (AT(p) == '+') ++p;
+		else if (AT(p) == '-') { eneg = 1; ++p; }
+		if (!ISDIGIT(AT(p))) return LYNX_PARSE_INVALID_VALUE;
+		//指数再大结果也只会是0或者溢出，限制大小防止整数溢出
+		for (; ISDIGIT(AT(p)); ++p) {
+			if (exp < 100000) exp = exp * 10 + (*p - '0');
+		}
+		if (eneg) exp = -exp;
+	}
+
+	if (p == int_end && p - digits <= 19 && (!neg || (m != 0 && m <= (uint64_t)1 << 63))) {
+		//没有小数和指数部分、不超过19位的整数直接以整数存储；"-0"仍然作为double以保留符号
+		if (!neg) {
+			v->u.u64 = m;
+			v->flags = m > INT64_MAX ? LYNX_FLAG_UINT64 : LYNX_FLAG_INT64;
+		} else {
+			v->u.i64 = m == (uint64_t)1 << 63 ? INT64_MIN : -(int64_t)m;
+			v->flags = LYNX_FLAG_INT64;
+		}
+		c->json = p;
+		v->type = LYNX_NUMBER;
+		return LYNX_PARSE_OK;
+	}
+	if (p == int_end && p - digits == 20 && !neg && m <= (UINT64_MAX - (unsigned)(p[-1] - '0')) / 10) {
+		//20位的整数可能仍在uint64_t范围内
+		v->u.u64 = m * 10 + (unsigned)(p[-1] - '0');
+		v->flags = LYNX_FLAG_UINT64;
+		c->json = p;
+		v->type = LYNX_NUMBER;
+		return LYNX_PARSE_OK;
+	}
+
+	if (m == 0) {
+		d = 0.0;
+	} else
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+	if (!truncated && m <= ((uint64_t)1 << 53) && e10 + exp >= -22 && e10 + exp <= 22) {
+		//尾数和10的幂都能精确表示为double，一次运算只舍入一次
+		d = (double)m;
+		if (e10 + exp < 0) d /= lynx_pow10_exact[-(e10 + exp)];
+		else d *= lynx_pow10_exact[e10 + exp];
+	} else
+#endif
+	{
+		bits = lynx_eisel_lemire(m, e10 + exp);
+		//截断的尾数m和m+1得到的结果不同时，需要精确比较才能确定舍入方向
+		if (truncated && bits != lynx_eisel_lemire(m + 1, e10 + exp))
+			bits = lynx_decimal_round(digits, p, exp, bits);
+		if (bits == LYNX_DOUBLE_INF_BITS)
+			return LYNX_PARSE_NUMBER_TOO_BIG;
+		memcpy(&d, &bits, sizeof(double));
+	}
+	v->u.n = neg ? -d : d;
 	c->json = p;
 	v->type = LYNX_NUMBER;
 	return LYNX_PARSE_OK;
 }
+#undef AT
 
 //应保证运行函数之前和之后栈的状态不变（top）
 #define STRING_ERROR(ret) do { c->top = head; return ret; } while (0)
 
-static int lynx_parse_string_raw(lynx_context* c, char** str, size_t* len)
-
+//解析'\\'之后的转义序列，不会读取end之后的内容，解码结果写入buf（至多4字节），长度存入*n
+//成功返回转义序列之后的位置，失败返回NULL，错误码存入*ret
+static const char* lynx_parse_escape(const char* p, const char* end, char* buf, size_t* n, int* ret)
 {
-	size_t head = c->top;
-	const char* p;
 	unsigned u, ul;
+	*n = 1;
+	switch (p != end ? *p++ : '\0') {
+		case '\"': 	*buf = '\"'; return p;
+		case '\\': 	*buf = '\\'; return p;
+		case '/': 	*buf = '/';  return p;
+		case 'b': 	*buf = '\b'; return p;
+		case 'f': 	*buf = '\f'; return p;
+		case 'n': 	*buf = '\n'; return p;
+		case 'r': 	*buf = '\r'; return p;
+		case 't': 	*buf = '\t'; return p;
+		case 'u':
+			if (!(p = lynx_parse_hex4(p, end, &u))) {
+				*ret = LYNX_PARSE_INVALID_UNICODE_HEX;
+				return NULL;
+			}
+			//处理代理对
+			if (0xD800 <= u && u <= 0xDBFF) {
+				//如果是高代理项，则下一个字符应是低代理项，才能得到正确的码点
+				if (end - p < 2 || p[0] != '\\' || p[1] != 'u') {
+					*ret = LYNX_PARSE_INVALID_UNICODE_SURROGATE;
+					return NULL;
+				}
+				if (!(p = lynx_parse_hex4(p + 2, end, &ul))) {
+					*ret = LYNX_PARSE_INVALID_UNICODE_HEX;
+					return NULL;
+				}
+				if (0xDC00 <= ul && ul <= 0xDFFF) {
+					u = 0x10000 + (u - 0xD800) * 0x400 + (ul - 0xDC00);
+				} else {
+					*ret = LYNX_PARSE_INVALID_UNICODE_SURROGATE;
+					return NULL;
+				}
+			}
+			*n = lynx_encode_utf8(buf, u);
+			return p;
+		default:
+			*ret = LYNX_PARSE_INVALID_STRING_ESCAPE;
+			return NULL;
+	}
+}
+
+static int lynx_parse_string_insitu(lynx_context* c, char** str, size_t* len);
+
+//解析JSON字符串，*str指向解码后的字符串：不含转义时直接指向输入，否则位于栈中（原地解析模式下位于输入缓冲区中）
+//解码结果没有'\0'结尾，只能按*len使用，并且必须在下一次压栈之前用完
+static int lynx_parse_string_raw(lynx_context* c, char** str, size_t* len)
+{
+	size_t head = c->top, n;
+	const char *p, *q;
+	char* buf;
+	int ret;
+	if (c->insitu) return lynx_parse_string_insitu(c, str, len);
 	EXPECT(c, '\"');
 	p = c->json;
+	//最常见的情况：整个字符串没有转义，不必复制进栈（调用者不会通过*str写入）
+	q = lynx_scan_string(p, c->end, c->limit);
+	if (q != c->end && *q == '\"') {
+		*str = (char*)p;
+		*len = (size_t)(q - p);
+		c->json = q + 1;
+		return LYNX_PARSE_OK;
+	}
 	while (1) {
+		//不含转义和控制字符的一段直接整体复制进栈，只有遇到特殊字符时才逐个处理
+		q = lynx_scan_string(p, c->end, c->limit);
+		if (q != p) {
+			PUTS(c, p, (size_t)(q - p));
+			p = q;
+		}
+		if (p == c->end) STRING_ERROR(LYNX_PARSE_MISS_QUOTATION_MARK);
 		char ch = *p++;
 		switch (ch) {
 			case '\\': {
-				switch(*p++) {
-					case '\"': 	PUTC(c, '\"'); break;
-					case '\\': 	PUTC(c, '\\'); break;
-					case '/': 	PUTC(c, '/');  break;
-					case 'b': 	PUTC(c, '\b'); break;
-					case 'f': 	PUTC(c, '\f'); break;
-					case 'n': 	PUTC(c, '\n'); break;
-					case 'r': 	PUTC(c, '\r'); break;
-					case 't': 	PUTC(c, '\t'); break;
-					case 'u':
-						if (!(p = lynx_parse_hex4(p, &u)))
-							return LYNX_PARSE_INVALID_UNICODE_HEX;
-						//处理代理对
-						if (0xD800 <= u && u <= 0xDBFF) {
-							//如果是高代理项，则下一个字符应是低代理项，才能得到正确的码点
-							if (*p++ != '\\') STRING_ERROR(LYNX_PARSE_INVALID_UNICODE_SURROGATE);
-							if (*p++ != 'u') STRING_ERROR(LYNX_PARSE_INVALID_UNICODE_SURROGATE);
-							if (!(p = lynx_parse_hex4(p, &ul)))
-								return LYNX_PARSE_INVALID_UNICODE_HEX;
-							if (0xDC00 <= ul && ul <= 0xDFFF) {
-								u = 0x10000 + (u - 0xD800) * 0x400 + (ul - 0xDC00);
-							} else {
-								return LYNX_PARSE_INVALID_UNICODE_SURROGATE;
-							}
-						}
-						lynx_encode_utf8(c, u);
-						break;
-					default:
-						STRING_ERROR(LYNX_PARSE_INVALID_STRING_ESCAPE);
-				}
+				buf = lynx_context_push(c, 4);
+				if (!(p = lynx_parse_escape(p, c->end, buf, &n, &ret)))
+					STRING_ERROR(ret);
+				c->top -= 4 - n;
 				break;
 			}
 			case '\"': {
@@ -232,190 +2031,2436 @@ static int lynx_parse_string_raw(lynx_context* c, char** str, size_t* len)
 				c->json = p;
 				return LYNX_PARSE_OK;
 			}
-			case '\0': {
-				STRING_ERROR(LYNX_PARSE_MISS_QUOTATION_MARK);
-			}
 			default: {
-				//不能出现控制字符如'\b'
-				if ((unsigned char)ch < 0x20) {
-					STRING_ERROR(LYNX_PARSE_INVALID_STRING_CHAR);
-				}
-				PUTC(c, ch);
+				//扫描函数只会停在特殊字符上，剩下的只可能是控制字符如'\b'（包括长度给定的输入中间的'\0'）
+				assert((unsigned char)ch < 0x20);
+				STRING_ERROR(LYNX_PARSE_INVALID_STRING_CHAR);
+			}
+		}
+	}
+}
+
+//原地解析字符串：解码后的内容写回输入缓冲区中字符串开始的位置，并以'\0'结尾
+//转义序列解码后的长度总是不超过转义序列本身，所以写入位置不会超过读取位置
+static int lynx_parse_string_insitu(lynx_context* c, char** str, size_t* len)
+{
+	char *w, buf[4];
+	const char *p, *q;
+	size_t n;
+	int ret;
+	EXPECT(c, '\"');
+	p = c->json;
+	*str = w = (char*)p;
+	while (1) {
+		q = lynx_scan_string(p, c->end, c->limit);
+		if (w != p) memmove(w, p, (size_t)(q - p));
+		w += q - p;
+		p = q;
+		if (p == c->end) return LYNX_PARSE_MISS_QUOTATION_MARK;
+		char ch = *p++;
+		switch (ch) {
+			case '\\': {
+				if (!(p = lynx_parse_escape(p, c->end, buf, &n, &ret)))
+					return ret;
+				memcpy(w, buf, n);
+				w += n;
+				break;
+			}
+			case '\"': {
+				*w = '\0';
+				*len = (size_t)(w - *str);
+				c->json = p;
+				return LYNX_PARSE_OK;
 			}
+			default: return LYNX_PARSE_INVALID_STRING_CHAR;
 		}
 	}
 }
 
+static char* lynx_arena_strdup(lynx_document* doc, const char* s, size_t len)
+{
+	char* ret = (char*)lynx_arena_alloc(doc, len + 1);
+	memcpy(ret, s, len);
+	ret[len] = '\0';
+	return ret;
+}
+
+static void lynx_set_string_raw(lynx_value* v, const char* s, size_t len);
+
+//把解析出的字符串存入v（v不持有资源）：原地解析时直接引用输入缓冲区中的字符串，解析到文档时复制到arena中，
+//短字符串总是直接存放在节点中
+static void lynx_context_set_string(lynx_context* c, lynx_value* v, char* s, size_t len)
+{
+	if (len <= LYNX_SHORT_STRING_MAX || (!c->insitu && !c->doc)) {
+		lynx_set_string_raw(v, s, len);
+		return;
+	}
+	assert(len <= (lynx_size)-1);
+	v->type = LYNX_STRING;
+	v->flags = LYNX_FLAG_BORROWED;
+	v->u.s = c->insitu ? s : lynx_arena_strdup(c->doc, s, len);
+	v->size = (lynx_size)len;
+}
+
+//对象的键：使用键表时引用其中的副本
+static void lynx_context_set_key(lynx_context* c, lynx_value* k, char* s, size_t len)
+{
+	if (!c->keys || len <= LYNX_SHORT_STRING_MAX) {
+		lynx_context_set_string(c, k, s, len);
+		return;
+	}
+	assert(len <= (lynx_size)-1);
+	k->type = LYNX_STRING;
+	k->flags = LYNX_FLAG_BORROWED | LYNX_FLAG_INTERNED;
+	k->u.s = (char*)lynx_key_table_intern(c->keys, s, len);
+	k->size = (lynx_size)len;
+}
+
 static int lynx_parse_string(lynx_context* c, lynx_value* v)
 {
 	char* s;
 	size_t len;
 	int ret = lynx_parse_string_raw(c, &s, &len);
-	if (ret == LYNX_PARSE_OK) {
-		lynx_set_string(v, s, len);
-	}
+	if (ret == LYNX_PARSE_OK)
+		lynx_context_set_string(c, v, s, len);
 	return ret;
 }
 
-//lynx_parse_array()与lynx_parse_value()相互调用，故加入前向声明
-static int lynx_parse_value(lynx_context* c, lynx_value* v);
+//弹出栈顶的size个元素，组成数组存入v
+static void lynx_context_pop_array(lynx_context* c, lynx_value* v, size_t size)
+{
+	if (c->doc) {
+		v->type = LYNX_ARRAY;
+		v->flags = LYNX_FLAG_BORROWED | LYNX_FLAG_DOCUMENT;
+		v->u.e = (lynx_value*)lynx_arena_alloc_owned(c->doc, size * sizeof(lynx_value));
+	} else {
+		lynx_set_array(v, size);
+	}
+	v->size = size;
+	if (size > 0)
+		memcpy(v->u.e, lynx_context_pop(c, size * sizeof(lynx_value)), size * sizeof(lynx_value));
+}
+
+//弹出栈顶的size个成员，组成对象存入v
+static void lynx_context_pop_object(lynx_context* c, lynx_value* v, size_t size)
+{
+	if (c->doc) {
+		//需要索引的对象直接在arena中预留索引头，避免之后复制到堆上
+		size_t header = size >= LYNX_OBJECT_INDEX_THRESHOLD ? LYNX_INDEX_HEADER_SIZE : 0;
+		v->type = LYNX_OBJECT;
+		v->flags = LYNX_FLAG_BORROWED | LYNX_FLAG_DOCUMENT;
+		v->u.m = (lynx_member*)((char*)lynx_arena_alloc_owned(c->doc, header + size * sizeof(lynx_member)) + header);
+		if (header) {
+			v->flags |= LYNX_FLAG_INDEXED;
+			LYNX_OBJECT_INDEX(v)->slots = NULL;
+		}
+	} else {
+		lynx_set_object(v, size);
+	}
+	v->size = size;
+	if (size > 0)
+		memcpy(v->u.m, lynx_context_pop(c, size * sizeof(lynx_member)), size * sizeof(lynx_member));
+	if (size >= LYNX_OBJECT_INDEX_THRESHOLD)
+		lynx_build_object_index(v);
+}
+
+//value = null / false / true / number /string（数组和对象见lynx_parse_value()）
+static int lynx_parse_scalar(lynx_context* c, lynx_value* v)
+{
+	switch (PEEK(c)) {
+		case 'n':   return lynx_parse_literal(c, v, "null", LYNX_NULL);
+		case 't':   return lynx_parse_literal(c, v, "true", LYNX_TRUE);
+		case 'f':   return lynx_parse_literal(c, v, "false", LYNX_FALSE);
+		case '\"':	return lynx_parse_string(c, v);
+		default:    return lynx_parse_number(c, v);
+		case '\0':  return c->json == c->end ? LYNX_PARSE_EXPECT_VALUE : LYNX_PARSE_INVALID_VALUE;	//范围内的'\0'是非法字符
+	}
+}
+
+/*
+数组和对象的解析不使用递归
+	遇到'['或'{'时在解析栈中压入一个lynx_parse_frame保存外层的状态，这一层之后解析出的元素/成员都压在它的上面；
+	遇到']'或'}'时把它们弹出组成节点，再弹出frame恢复外层的状态，节点作为一个完整的值交给外层。
+	所以嵌套再深也只占用解析栈（堆内存），不占用调用栈，嵌套层数由lynx_context::max_depth限制。
+	当前这一层的状态只放在局部变量中（不取地址，以便留在寄存器里），进出一层时才读写frame。
+*/
+typedef struct {
+	size_t parent;	//外层frame在栈中的位置，最外层为LYNX_NO_FRAME
+	size_t size;	//外层已经压栈的元素/成员个数（对象的成员在读到键时压栈，值之后再填入）
+	lynx_type type;	//外层的类型，最外层为LYNX_NULL
+} lynx_parse_frame;
+
+#define LYNX_NO_FRAME ((size_t)-1)
+#define FRAME_AT(c, pos) ((lynx_parse_frame*)((c)->stack + (pos)))
+
+//保存外层的状态，返回frame在栈中的位置
+static size_t lynx_parse_enter(lynx_context* c, size_t frame, size_t size, lynx_type type)
+{
+	lynx_parse_frame* f = (lynx_parse_frame*)lynx_context_push(c, sizeof(lynx_parse_frame));
+	f->parent = frame;
+	f->size = size;
+	f->type = type;
+	return c->top - sizeof(lynx_parse_frame);
+}
 
-static int lynx_parse_array(lynx_context* c, lynx_value* v)
+//解析对象中的键，键和一个空值作为成员压栈（值之后再填入）
+static int lynx_parse_key(lynx_context* c)
 {
-	size_t size = 0;
+	lynx_member m;
+	char* s;
+	size_t len;
 	int ret;
-	EXPECT(c, '[');
-	lynx_parse_whitespace(c);
-	if (*c->json == ']') {
-		++c->json;
-		lynx_set_array(v, 0);
-		return LYNX_PARSE_OK;
+	if (PEEK(c) != '\"') return LYNX_PARSE_MISS_KEY;
+	if ((ret = lynx_parse_string_raw(c, &s, &len)) != LYNX_PARSE_OK) return ret;
+	//这里的s指向栈中的字符串（原地解析时指向输入缓冲区，可以直接使用）
+	lynx_context_set_key(c, &m.k, s, len);
+	lynx_init(&m.v);
+	memcpy(lynx_context_push(c, sizeof(lynx_member)), &m, sizeof(lynx_member));
+	return LYNX_PARSE_OK;
+}
+
+//出错时从内到外释放还没有结束的各层中已解析的元素/成员（特别是字符串、数组和对象等管理资源的JSON值）
+static void lynx_parse_unwind(lynx_context* c, size_t frame, size_t size, lynx_type type)
+{
+	while (frame != LYNX_NO_FRAME) {
+		lynx_parse_frame* f = FRAME_AT(c, frame);
+		char* p = c->stack + frame + sizeof(lynx_parse_frame);
+		for (size_t i = 0; i < size; ++i) {
+			if (type == LYNX_ARRAY) {
+				lynx_free((lynx_value*)p + i);
+			} else {
+				lynx_member* m = (lynx_member*)p + i;
+				lynx_free(&m->k);
+				lynx_free(&m->v);
+			}
+		}
+		c->top = frame;
+		frame = f->parent;
+		size = f->size;
+		type = f->type;
 	}
+}
+
+//value = null / false / true / number /string /array /object
+static int lynx_parse_value(lynx_context* c, lynx_value* v)
+{
+	size_t frame = LYNX_NO_FRAME, size = 0, depth = 0;
+	lynx_type type = LYNX_NULL;	//当前所在的一层
+	lynx_parse_frame* f;
+	lynx_value e;	//刚刚解析完成的值
+	int ret = LYNX_PARSE_OK, key = 0;
+	char ch;
 	while (1) {
-		lynx_value e;	//临时存放解析出的数组元素
-		lynx_init(&e);
-		ret = lynx_parse_value(c, &e);
-		if (ret != LYNX_PARSE_OK) {
-			break;
-		}
-		//把临时元素压栈
-		memcpy(lynx_context_push(c, sizeof(lynx_value)), &e, sizeof(lynx_value));
-		++size;
-		lynx_parse_whitespace(c);
-		if (*c->json == ']') {
+		//对象中先解析键和':'
+		if (key) {
+			if ((ret = lynx_parse_key(c)) != LYNX_PARSE_OK) break;
+			++size;	//成员已经压栈，之后出错时由lynx_parse_unwind()释放
+			lynx_parse_whitespace(c);
+			if (PEEK(c) != ':') {
+				ret = LYNX_PARSE_MISS_COLON;
+				break;
+			}
 			++c->json;
-			lynx_set_array(v, size);
-			v->u.a.size = size;
-			size *= sizeof(lynx_value);
-			memcpy(v->u.a.e, lynx_context_pop(c, size), size);
-			return LYNX_PARSE_OK;
-		} else
-		if (*c->json == ',') {
+			lynx_parse_whitespace(c);
+		}
+		//这里需要一个值：进入一层数组/对象，或者解析一个标量
+		ch = PEEK(c);
+		if (ch == '[' || ch == '{') {
+			if (depth == c->max_depth) {
+				ret = LYNX_PARSE_DEPTH_EXCEEDED;
+				break;
+			}
+			frame = lynx_parse_enter(c, frame, size, type);
+			size = 0;
+			type = ch == '[' ? LYNX_ARRAY : LYNX_OBJECT;
+			++depth;
 			++c->json;
+			lynx_parse_whitespace(c);
+			key = type == LYNX_OBJECT;
+			if (PEEK(c) != (ch == '[' ? ']' : '}')) continue;
+			//空数组/对象：直接结束这一层
 		} else {
-			ret = LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-			break;
+			lynx_init(&e);
+			if ((ret = lynx_parse_scalar(c, &e)) != LYNX_PARSE_OK) break;
+			if (type == LYNX_NULL) break;
+			if (type == LYNX_ARRAY) {
+				memcpy(lynx_context_push(c, sizeof(lynx_value)), &e, sizeof(lynx_value));
+				++size;
+			} else {
+				//成员在解析键时已经压栈，值的子节点都已经出栈，所以它就在栈顶
+				memcpy(&((lynx_member*)(c->stack + c->top) - 1)->v, &e, sizeof(lynx_value));
+			}
+			lynx_parse_whitespace(c);
 		}
-		lynx_parse_whitespace(c);
-	}
-	//只有出错时才会运行下面的代码
 
-	//释放栈中已解析的元素(特别是字符串、数组和对象等管理资源的JSON值)
-	for (size_t i = 0; i < size; ++i) {
-		lynx_free((lynx_value*)lynx_context_pop(c, sizeof(lynx_value)));
+		//一个值之后应该是','或者这一层的结尾；一层结束时组成节点交给外层，外层可能也随之结束
+		while (1) {
+			ch = PEEK(c);
+			if (ch == ',') {
+				++c->json;
+				lynx_parse_whitespace(c);
+				key = type == LYNX_OBJECT;
+				break;
+			}
+			if (ch != (type == LYNX_ARRAY ? ']' : '}')) {
+				ret = type == LYNX_ARRAY ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+				break;
+			}
+			++c->json;
+			lynx_init(&e);
+			if (type == LYNX_ARRAY)
+				lynx_context_pop_array(c, &e, size);
+			else
+				lynx_context_pop_object(c, &e, size);
+			f = FRAME_AT(c, frame);
+			assert(c->top == frame + sizeof(lynx_parse_frame));
+			c->top = frame;
+			frame = f->parent;
+			size = f->size;
+			type = f->type;
+			--depth;
+			if (type == LYNX_NULL) break;
+			if (type == LYNX_ARRAY) {
+				memcpy(lynx_context_push(c, sizeof(lynx_value)), &e, sizeof(lynx_value));
+				++size;
+			} else {
+				memcpy(&((lynx_member*)(c->stack + c->top) - 1)->v, &e, sizeof(lynx_value));
+			}
+			lynx_parse_whitespace(c);
+		}
+		if (ret != LYNX_PARSE_OK || type == LYNX_NULL) break;
 	}
+	if (ret == LYNX_PARSE_OK) {
+		memcpy(v, &e, sizeof(lynx_value));
+		return LYNX_PARSE_OK;
+	}
+	lynx_parse_unwind(c, frame, size, type);
 	return ret;
 }
 
-static void lynx_set_string_raw(char** rs, size_t* rlen, const char* s, size_t len);
-static int lynx_parse_string_raw(lynx_context* c, char** str, size_t* len);
-static int lynx_parse_object(lynx_context* c, lynx_value* v)
+/*
+SAX接口
+	与DOM解析共用空白、字面量、数字、字符串的解析函数，但不创建节点，每解析出一个值就调用lynx_handler中对应的回调。
+	字符串只在含有转义时才解码到栈中，栈是唯一的内存开销。
+*/
+#define SAX_CALL(c, f, args) ((c)->handler->f && (c)->handler->f args)	//回调返回非0表示中止解析
+
+//标量：解析之后调用对应的回调
+static int lynx_sax_scalar(lynx_context* c)
+{
+	lynx_value v;	//字面量和数字借用DOM的解析函数，不持有任何资源
+	char* s;
+	size_t len;
+	int ret, stop;
+	lynx_init(&v);
+	switch (PEEK(c)) {
+		case 'n':
+			if ((ret = lynx_parse_literal(c, &v, "null", LYNX_NULL)) != LYNX_PARSE_OK) return ret;
+			stop = SAX_CALL(c, null_value, (c->handler_ctx));
+			break;
+		case 't':
+			if ((ret = lynx_parse_literal(c, &v, "true", LYNX_TRUE)) != LYNX_PARSE_OK) return ret;
+			stop = SAX_CALL(c, boolean, (c->handler_ctx, 1));
+			break;
+		case 'f':
+			if ((ret = lynx_parse_literal(c, &v, "false", LYNX_FALSE)) != LYNX_PARSE_OK) return ret;
+			stop = SAX_CALL(c, boolean, (c->handler_ctx, 0));
+			break;
+		case '\"':
+			if ((ret = lynx_parse_string_raw(c, &s, &len)) != LYNX_PARSE_OK) return ret;
+			stop = SAX_CALL(c, string, (c->handler_ctx, s, len));
+			break;
+		case '\0':	return c->json == c->end ? LYNX_PARSE_EXPECT_VALUE : LYNX_PARSE_INVALID_VALUE;
+		default:
+			if ((ret = lynx_parse_number(c, &v)) != LYNX_PARSE_OK) return ret;
+			//没有提供整数回调时，整数按double交给number回调
+			if ((v.flags & LYNX_FLAG_INT64) && c->handler->int64)
+				stop = c->handler->int64(c->handler_ctx, v.u.i64);
+			else if ((v.flags & LYNX_FLAG_UINT64) && c->handler->uint64)
+				stop = c->handler->uint64(c->handler_ctx, v.u.u64);
+			else
+				stop = SAX_CALL(c, number, (c->handler_ctx, lynx_get_number(&v)));
+			break;
+	}
+	return stop ? LYNX_PARSE_TERMINATED : LYNX_PARSE_OK;
+}
+
+//解析对象中的键以及之后的':'
+static int lynx_sax_key(lynx_context* c)
 {
-	size_t size = 0;
+	char* s;
+	size_t len;
 	int ret;
-	EXPECT(c, '{');
+	if (PEEK(c) != '\"') return LYNX_PARSE_MISS_KEY;
+	if ((ret = lynx_parse_string_raw(c, &s, &len)) != LYNX_PARSE_OK) return ret;
+	if (SAX_CALL(c, key, (c->handler_ctx, s, len))) return LYNX_PARSE_TERMINATED;
 	lynx_parse_whitespace(c);
-	if (*c->json == '}') {
-		++c->json;
-		lynx_set_object(v, 0);
-		return LYNX_PARSE_OK;
-	}
+	if (PEEK(c) != ':') return LYNX_PARSE_MISS_COLON;
+	++c->json;
+	lynx_parse_whitespace(c);
+	return LYNX_PARSE_OK;
+}
 
+//与lynx_parse_value()结构相同，只是不创建节点，各层只记录元素/成员的个数
+static int lynx_sax_value(lynx_context* c)
+{
+	size_t frame = LYNX_NO_FRAME, size = 0, depth = 0, head = c->top, n;
+	lynx_type type = LYNX_NULL, t;
+	lynx_parse_frame* f;
+	int ret = LYNX_PARSE_OK, key = 0;
+	char ch;
 	while (1) {
-		lynx_member m;	//临时存放解析出的成员
-		m.k = NULL; m.klen = 0;
-		lynx_init(&m.v);
-		char* s; size_t len;
-		if (*c->json != '\"') {
-			ret = LYNX_PARSE_MISS_KEY;
-			break;
+		if (key && (ret = lynx_sax_key(c)) != LYNX_PARSE_OK) break;
+		ch = PEEK(c);
+		if (ch == '[' || ch == '{') {
+			if (depth == c->max_depth) {
+				ret = LYNX_PARSE_DEPTH_EXCEEDED;
+				break;
+			}
+			if (ch == '[' ? SAX_CALL(c, start_array, (c->handler_ctx)) : SAX_CALL(c, start_object, (c->handler_ctx))) {
+				ret = LYNX_PARSE_TERMINATED;
+				break;
+			}
+			frame = lynx_parse_enter(c, frame, size, type);
+			size = 0;
+			type = ch == '[' ? LYNX_ARRAY : LYNX_OBJECT;
+			++depth;
+			++c->json;
+			lynx_parse_whitespace(c);
+			key = type == LYNX_OBJECT;
+			if (PEEK(c) != (ch == '[' ? ']' : '}')) continue;
+		} else {
+			if ((ret = lynx_sax_scalar(c)) != LYNX_PARSE_OK || type == LYNX_NULL) break;
+			++size;
+			lynx_parse_whitespace(c);
 		}
-		ret = lynx_parse_string_raw(c, &s, &len);
-		//这里的s指向栈中的字符串
-		if (ret != LYNX_PARSE_OK) break;
-		lynx_set_string_raw(&(m.k), &(m.klen), s, len);
 
-		lynx_parse_whitespace(c);
-		if (*c->json == ':') ++c->json;
-		else {
-			ret = LYNX_PARSE_MISS_COLON;
-			free(m.k);
-			break;
+		while (1) {
+			ch = PEEK(c);
+			if (ch == ',') {
+				++c->json;
+				lynx_parse_whitespace(c);
+				key = type == LYNX_OBJECT;
+				break;
+			}
+			if (ch != (type == LYNX_ARRAY ? ']' : '}')) {
+				ret = type == LYNX_ARRAY ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+				break;
+			}
+			++c->json;
+			t = type;
+			n = size;
+			f = FRAME_AT(c, frame);
+			c->top = frame;
+			frame = f->parent;
+			size = f->size;
+			type = f->type;
+			--depth;
+			if (t == LYNX_ARRAY ? SAX_CALL(c, end_array, (c->handler_ctx, n)) : SAX_CALL(c, end_object, (c->handler_ctx, n))) {
+				ret = LYNX_PARSE_TERMINATED;
+				break;
+			}
+			if (type == LYNX_NULL) break;
+			++size;
+			lynx_parse_whitespace(c);
 		}
-		lynx_parse_whitespace(c);
+		if (ret != LYNX_PARSE_OK || type == LYNX_NULL) break;
+	}
+	c->top = head;	//frame不持有资源，直接丢弃
+	return ret;
+}
 
-		ret = lynx_parse_value(c, &m.v);
-		if (ret != LYNX_PARSE_OK) {
-			free(m.k);
-			break;
-		}
+int lynx_parse_sax(const char* json, const lynx_handler* h, void* ctx)
+{
+	lynx_context c;
+	int ret;
+	assert(json != NULL && h != NULL);
+	c.json = json;
+	c.end = c.limit = json + strlen(json);
+	c.stack = NULL;
+	c.size = c.top = 0;
+	c.allocator = &lynx_global_allocator;
+	c.insitu = 0;
+	c.max_depth = LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c.doc = NULL;
+	c.handler = h;
+	c.handler_ctx = ctx;
+	c.keys = NULL;
+	c.write = NULL;
+	lynx_parse_whitespace(&c);
+	ret = lynx_sax_value(&c);
+	if (ret == LYNX_PARSE_OK) {
+		lynx_parse_whitespace(&c);
+		if (c.json != c.end)
+			ret = LYNX_PARSE_ROOT_NOT_SINGULAR;
+	}
+	assert(c.top == 0);
+	if (c.stack) LYNX_FREE(c.allocator, c.stack);
+	return ret;
+}
 
-		//成功读取一个成员，压栈
-		memcpy(lynx_context_push(c, sizeof(lynx_member)), &m, sizeof(lynx_member));
-		++size;
+static int lynx_parse_root(lynx_context* c, lynx_value* v)
+{
+	int ret;
+	lynx_init(v);
+	lynx_parse_whitespace(c);
+	ret = lynx_parse_value(c, v);
+	if (ret == LYNX_PARSE_OK) {
 		lynx_parse_whitespace(c);
-		if (*c->json == '}') {
-			++c->json;
-			lynx_set_object(v, size);
-			v->u.o.size = size;
-			size *= sizeof(lynx_member);
-			memcpy(v->u.o.m, lynx_context_pop(c, size), size);
-			return LYNX_PARSE_OK;
-		} else
-		if (*c->json == ',') {
-			++c->json;
-		} else {
-			ret = LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+		if (c->json != c->end) {
+			lynx_set_null(v);
+			ret = LYNX_PARSE_ROOT_NOT_SINGULAR;
+		}
+	}
+	assert(c->top == 0);	//栈中不能有残留
+	return ret;
+}
+
+static int lynx_parse_buffer(lynx_value* v, const char* json, size_t len, int insitu, const lynx_parse_options* opt)
+{
+	lynx_context c;
+	int ret;
+	assert(v != NULL && json != NULL);
+	c.json = json;
+	c.end = json + len;
+	c.limit = c.end + (opt ? opt->padding : 0);
+	c.stack = NULL;
+	c.size = c.top = 0;
+	c.allocator = opt && opt->allocator ? opt->allocator : &lynx_global_allocator;
+	c.insitu = insitu;
+	c.max_depth = opt && opt->max_depth ? opt->max_depth : LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c.doc = NULL;
+	c.keys = opt ? opt->keys : NULL;
+	c.write = NULL;
+	ret = lynx_parse_root(&c, v);
+	if (c.stack) LYNX_FREE(c.allocator, c.stack);
+	return ret;
+}
+
+int lynx_parse(lynx_value* v, const char* json)
+{
+	assert(json != NULL);
+	return lynx_parse_buffer(v, json, strlen(json), 0, NULL);
+}
+
+int lynx_parse_ex(lynx_value* v, const char* json, const lynx_parse_options* opt)
+{
+	assert(json != NULL);
+	return lynx_parse_buffer(v, json, strlen(json), 0, opt);
+}
+
+int lynx_parse_n(lynx_value* v, const char* json, size_t len)
+{
+	return lynx_parse_buffer(v, json, len, 0, NULL);
+}
+
+int lynx_parse_n_ex(lynx_value* v, const char* json, size_t len, const lynx_parse_options* opt)
+{
+	return lynx_parse_buffer(v, json, len, 0, opt);
+}
+
+int lynx_parse_insitu(lynx_value* v, char* json)
+{
+	assert(json != NULL);
+	return lynx_parse_buffer(v, json, strlen(json), 1, NULL);
+}
+
+/*
+文件输入
+	普通文件以只读方式映射到内存，直接在映射的页面上解析（lynx_parse_n()不需要'\0'结尾，文件大小恰好是页面整数倍时也不会越界），
+	除了解码出的值以外没有任何复制。映射失败（如管道、不支持映射的平台）或者指定了LYNX_FILE_NO_MMAP时，才把整个文件读入缓冲区。
+*/
+typedef struct {
+	const char* data;
+	size_t len;
+	size_t padding;	//最后一页中文件结尾之后的部分同样可以读取（内容为0）
+	int mapped;		//data是否为映射的页面
+	char* buffer;	//lynx_file_read()从全局分配器申请的缓冲区，没有时为NULL
+} lynx_file;
+
+#ifdef LYNX_HAVE_MMAP
+//成功返回0
+static int lynx_file_map(lynx_file* f, const char* path)
+{
+#if defined(_WIN32)
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+	SYSTEM_INFO info;
+	file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return -1;
+	if (!GetFileSizeEx(file, &size) || (unsigned long long)size.QuadPart > (size_t)-1) {
+		CloseHandle(file);
+		return -1;
+	}
+	f->len = (size_t)size.QuadPart;
+	f->data = "";
+	f->padding = 0;
+	f->mapped = 0;
+	f->buffer = NULL;
+	if (f->len > 0) {
+		//映射视图持有映射对象的引用，两个句柄都可以立即关闭
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		f->data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+		if (mapping) CloseHandle(mapping);
+		if (!f->data) {
+			CloseHandle(file);
+			return -1;
+		}
+		GetSystemInfo(&info);
+		f->padding = (info.dwPageSize - f->len % info.dwPageSize) % info.dwPageSize;
+		f->mapped = 1;
+	}
+	CloseHandle(file);
+	return 0;
+#else
+	struct stat st;
+	void* p;
+	long page;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (unsigned long long)st.st_size > (size_t)-1) {
+		close(fd);
+		return -1;
+	}
+	f->len = (size_t)st.st_size;
+	f->data = "";
+	f->padding = 0;
+	f->mapped = 0;
+	f->buffer = NULL;
+	if (f->len > 0) {
+		p = mmap(NULL, f->len, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) {
+			close(fd);
+			return -1;
+		}
+		//从头到尾只读一遍，提示内核加大预读并及时回收读过的页面
+		posix_madvise(p, f->len, POSIX_MADV_SEQUENTIAL);
+		page = sysconf(_SC_PAGESIZE);
+		f->data = (const char*)p;
+		f->padding = page > 0 ? ((size_t)page - f->len % (size_t)page) % (size_t)page : 0;
+		f->mapped = 1;
+	}
+	close(fd);
+	return 0;
+#endif
+}
+#endif
+
+//把整个文件读入缓冲区，成功返回0
+static int lynx_file_read(lynx_file* f, const char* path)
+{
+	FILE* fp = fopen(path, "rb");
+	char* buf = NULL;
+	size_t size = 0, len = 0, n;
+	if (!fp) return -1;
+	do {
+		if (len == size) {
+			size = size ? size + (size >> 1) : 4096;
+			buf = (char*)REALLOC(buf, size);
+		}
+		n = fread(buf + len, 1, size - len, fp);
+		len += n;
+	} while (n > 0);
+	if (ferror(fp)) {
+		FREE(buf);
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+	f->data = f->buffer = buf;
+	f->len = len;
+	f->padding = size - len;
+	f->mapped = 0;
+	return 0;
+}
+
+static int lynx_file_open(lynx_file* f, const char* path, int flags)
+{
+#ifdef LYNX_HAVE_MMAP
+	if (!(flags & LYNX_FILE_NO_MMAP) && lynx_file_map(f, path) == 0)
+		return 0;
+#else
+	(void)flags;
+#endif
+	return lynx_file_read(f, path);
+}
+
+static void lynx_file_close(lynx_file* f)
+{
+	if (f->mapped) {
+#if defined(_WIN32)
+		UnmapViewOfFile(f->data);
+#elif defined(LYNX_HAVE_MMAP)
+		munmap((void*)f->data, f->len);
+#endif
+	}
+	if (f->buffer) FREE(f->buffer);
+}
+
+int lynx_parse_file(lynx_value* v, const char* path, int flags)
+{
+	lynx_file f;
+	lynx_parse_options opt;
+	int ret;
+	assert(v != NULL && path != NULL);
+	if (lynx_file_open(&f, path, flags) != 0) {
+		lynx_init(v);
+		return LYNX_PARSE_FILE_ERROR;
+	}
+	memset(&opt, 0, sizeof(opt));
+	opt.padding = f.padding;
+	ret = lynx_parse_n_ex(v, f.data, f.len, &opt);
+	lynx_file_close(&f);
+	return ret;
+}
+
+/*
+线程
+	Windows上使用Win32线程（需要Vista以上的条件变量），其他平台使用pthread（链接时需要-pthread）。
+	定义LYNX_NO_THREADS时不创建线程，锁都是空操作，多线程解析的接口在调用线程中完成所有工作。
+	工作线程创建的节点同样来自全局分配器，因此它必须是线程安全的（默认的malloc/free是）。
+*/
+#ifndef LYNX_NO_THREADS
+#if defined(_WIN32)
+typedef HANDLE lynx_thread;
+typedef CRITICAL_SECTION lynx_mutex;
+typedef CONDITION_VARIABLE lynx_cond;
+typedef LPTHREAD_START_ROUTINE lynx_thread_proc;
+#define LYNX_THREAD_PROC(name, arg) static DWORD WINAPI name(LPVOID arg)
+#define LYNX_THREAD_RETURN return 0
+#define lynx_thread_create(t, f, arg) ((*(t) = CreateThread(NULL, 0, f, arg, 0, NULL)) != NULL ? 0 : -1)
+#define lynx_thread_join(t) do { WaitForSingleObject(t, INFINITE); CloseHandle(t); } while(0)
+#define lynx_mutex_init(m) InitializeCriticalSection(m)
+#define lynx_mutex_destroy(m) DeleteCriticalSection(m)
+#define lynx_mutex_lock(m) EnterCriticalSection(m)
+#define lynx_mutex_unlock(m) LeaveCriticalSection(m)
+#define lynx_cond_init(cv) InitializeConditionVariable(cv)
+#define lynx_cond_destroy(cv) ((void)0)
+#define lynx_cond_wait(cv, m) SleepConditionVariableCS(cv, m, INFINITE)
+#define lynx_cond_broadcast(cv) WakeAllConditionVariable(cv)
+#else
+typedef pthread_t lynx_thread;
+typedef pthread_mutex_t lynx_mutex;
+typedef pthread_cond_t lynx_cond;
+typedef void* (*lynx_thread_proc)(void*);
+#define LYNX_THREAD_PROC(name, arg) static void* name(void* arg)
+#define LYNX_THREAD_RETURN return NULL
+#define lynx_thread_create(t, f, arg) pthread_create(t, NULL, f, arg)
+#define lynx_thread_join(t) pthread_join(t, NULL)
+#define lynx_mutex_init(m) pthread_mutex_init(m, NULL)
+#define lynx_mutex_destroy(m) pthread_mutex_destroy(m)
+#define lynx_mutex_lock(m) pthread_mutex_lock(m)
+#define lynx_mutex_unlock(m) pthread_mutex_unlock(m)
+#define lynx_cond_init(cv) pthread_cond_init(cv, NULL)
+#define lynx_cond_destroy(cv) pthread_cond_destroy(cv)
+#define lynx_cond_wait(cv, m) pthread_cond_wait(cv, m)
+#define lynx_cond_broadcast(cv) pthread_cond_broadcast(cv)
+#endif
+
+//nthreads为0时使用的线程数
+static size_t lynx_cpu_count(void)
+{
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (size_t)n : 1;
+#endif
+}
+
+//对n个大小为size的参数分别执行f，第0个在调用线程中执行，全部完成后返回；线程创建失败时改在调用线程中执行
+static void lynx_fork_join(lynx_thread_proc f, void* args, size_t n, size_t size)
+{
+	lynx_thread* threads = (lynx_thread*)MALLOC(n * sizeof(lynx_thread));
+	size_t i, started;
+	for (i = 1; i < n; i++)
+		if (lynx_thread_create(&threads[i], f, (char*)args + i * size) != 0) break;
+	started = i;
+	f(args);
+	for (i = started; i < n; i++)
+		f((char*)args + i * size);
+	for (i = 1; i < started; i++)
+		lynx_thread_join(threads[i]);
+	FREE(threads);
+}
+#else
+typedef int lynx_mutex;
+typedef int lynx_cond;
+#define lynx_mutex_init(m) ((void)(m))
+#define lynx_mutex_destroy(m) ((void)(m))
+#define lynx_mutex_lock(m) ((void)(m))
+#define lynx_mutex_unlock(m) ((void)(m))
+#define lynx_cond_init(cv) ((void)(cv))
+#define lynx_cond_destroy(cv) ((void)(cv))
+#define lynx_cond_wait(cv, m) assert(!"no other thread to wait for")
+#define lynx_cond_broadcast(cv) ((void)(cv))
+#endif
+
+//工作线程各自的解析上下文，解析栈在多次解析之间重复使用
+static void lynx_worker_context_init(lynx_context* c)
+{
+	c->stack = NULL;
+	c->size = c->top = 0;
+	c->allocator = &lynx_global_allocator;
+	c->insitu = 0;
+	c->max_depth = LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c->doc = NULL;
+	c->keys = NULL;	//键表不是线程安全的
+	c->write = NULL;
+}
+
+/*
+JSON Lines
+	输入只在'\n'处切成约LYNX_LINES_CHUNK_SIZE字节的块，线程每次领取下一块，逐行解析，结果暂存在块中，
+	由调用线程按输入顺序（LYNX_LINES_UNORDERED时按完成顺序）交给回调。调用线程没有可交付的块时也领取块来解析，所以工作线程全部创建失败也能完成。
+	块放在环形缓冲区中，领取的块最多比最早未交付的块超前LYNX_LINES_WINDOW个，解析不会远远超前于交付，内存占用与输入的大小无关。
+	行号在交付时才知道：块被领取后先数出其中的行数，它之前所有块的行数都数完之后，它的起始行号才确定。
+*/
+#ifndef LYNX_LINES_CHUNK_SIZE
+#define LYNX_LINES_CHUNK_SIZE (256 * 1024)
+#endif
+#define LYNX_LINES_WINDOW(nthreads) ((nthreads) * 4)
+
+typedef struct {
+	size_t line;	//块内的行号，从0开始
+	int ret;
+	lynx_value v;
+} lynx_line_result;
+
+typedef struct {
+	const char* begin;
+	const char* end;
+	size_t lines;		//块中的行数，counted之后有效
+	size_t base;		//块的第一行之前的行数，交付前确定
+	lynx_line_result* results;	//空白行没有结果
+	size_t count, capacity;
+	int counted, done, delivered;
+} lynx_lines_chunk;
+
+typedef struct {
+	const char* pos;	//下一块的开头
+	const char* end;
+	lynx_lines_chunk* chunks;	//第i块在chunks[i % window]中
+	size_t window;
+	size_t next;		//下一个领取的块
+	size_t oldest;		//最早的未交付的块
+	size_t frontier;	//[0, frontier)中的块都已确定起始行号
+	size_t lines;		//[0, frontier)中的总行数
+	int stop;			//回调中止了解析，不再领取新的块
+	lynx_mutex mutex;
+	lynx_cond cond;		//任何状态变化都广播
+} lynx_lines;
+
+#define LYNX_LINES_CHUNK(l, i) (&(l)->chunks[(i) % (l)->window])
+
+//在锁中调用，领取下一块，没有可领取的块时返回NULL
+static lynx_lines_chunk* lynx_lines_take(lynx_lines* l)
+{
+	lynx_lines_chunk* k;
+	const char* e;
+	if (l->stop || l->pos == l->end || l->next == l->oldest + l->window) return NULL;
+	k = LYNX_LINES_CHUNK(l, l->next++);
+	k->begin = l->pos;
+	if ((size_t)(l->end - l->pos) <= LYNX_LINES_CHUNK_SIZE)
+		e = l->end;
+	else {
+		e = (const char*)memchr(l->pos + LYNX_LINES_CHUNK_SIZE, '\n', l->end - l->pos - LYNX_LINES_CHUNK_SIZE);
+		e = e ? e + 1 : l->end;
+	}
+	k->end = l->pos = e;
+	k->count = 0;
+	k->counted = k->done = k->delivered = 0;
+	return k;
+}
+
+//在锁外调用
+static void lynx_lines_parse_chunk(lynx_lines* l, lynx_lines_chunk* k, lynx_context* c)
+{
+	const char *p, *q, *next;
+	size_t lines = 0;
+	lynx_line_result* r;
+	for (p = k->begin; p != k->end && (q = (const char*)memchr(p, '\n', k->end - p)) != NULL; p = q + 1)
+		lines++;
+	if (p != k->end) lines++;	//输入的最后一行没有'\n'
+	lynx_mutex_lock(&l->mutex);
+	k->lines = lines;
+	k->counted = 1;
+	lynx_cond_broadcast(&l->cond);
+	lynx_mutex_unlock(&l->mutex);
+
+	for (p = k->begin, lines = 0; p != k->end; p = next, lines++) {
+		//每行不含结尾的'\n'，错误码与对这一行单独调用lynx_parse()相同
+		q = (const char*)memchr(p, '\n', k->end - p);
+		next = q ? q + 1 : k->end;
+		c->json = p;
+		c->end = q ? q : k->end;
+		c->limit = l->end;	//块之后的输入同样可以读取
+		lynx_parse_whitespace(c);
+		if (c->json == c->end) continue;
+		if (k->count == k->capacity) {
+			k->capacity = k->capacity ? k->capacity + (k->capacity >> 1) : 64;
+			k->results = (lynx_line_result*)REALLOC(k->results, k->capacity * sizeof(lynx_line_result));
+		}
+		r = &k->results[k->count++];
+		r->line = lines;
+		r->ret = lynx_parse_root(c, &r->v);
+	}
+	lynx_mutex_lock(&l->mutex);
+	k->done = 1;
+	lynx_cond_broadcast(&l->cond);
+	lynx_mutex_unlock(&l->mutex);
+}
+
+#ifndef LYNX_NO_THREADS
+LYNX_THREAD_PROC(lynx_lines_worker, arg)
+{
+	lynx_lines* l = (lynx_lines*)arg;
+	lynx_lines_chunk* k;
+	lynx_context c;
+	lynx_worker_context_init(&c);
+	lynx_mutex_lock(&l->mutex);
+	for (;;) {
+		if ((k = lynx_lines_take(l)) != NULL) {
+			lynx_mutex_unlock(&l->mutex);
+			lynx_lines_parse_chunk(l, k, &c);
+			lynx_mutex_lock(&l->mutex);
+		}
+		else if (l->stop || l->pos == l->end)
+			break;
+		else
+			lynx_cond_wait(&l->cond, &l->mutex);	//窗口已满，等待交付
+	}
+	lynx_mutex_unlock(&l->mutex);
+	if (c.stack) FREE(c.stack);
+	LYNX_THREAD_RETURN;
+}
+#endif
+
+//在锁中调用，返回下一个可以交付的块
+static lynx_lines_chunk* lynx_lines_ready(lynx_lines* l, int unordered)
+{
+	lynx_lines_chunk* k;
+	size_t i;
+	while (l->frontier != l->next && (k = LYNX_LINES_CHUNK(l, l->frontier))->counted) {
+		k->base = l->lines;
+		l->lines += k->lines;
+		l->frontier++;
+	}
+	for (i = l->oldest; i != l->frontier; i++) {
+		k = LYNX_LINES_CHUNK(l, i);
+		if (k->done && !k->delivered) return k;
+		if (!unordered) break;
+	}
+	return NULL;
+}
+
+int lynx_parse_lines(const char* buf, size_t len, size_t nthreads, int flags, lynx_line_handler fn, void* ctx)
+{
+	lynx_lines l;
+	lynx_lines_chunk* k;
+	lynx_context c;
+	size_t i, workers = 0;
+#ifndef LYNX_NO_THREADS
+	lynx_thread* threads = NULL;
+#endif
+	assert((buf != NULL || len == 0) && fn != NULL);
+#ifndef LYNX_NO_THREADS
+	if (nthreads == 0) nthreads = lynx_cpu_count();
+	//块数不多时不需要那么多线程
+	workers = nthreads - 1;
+	if (workers > len / LYNX_LINES_CHUNK_SIZE) workers = len / LYNX_LINES_CHUNK_SIZE;
+#else
+	(void)nthreads;
+#endif
+	l.pos = buf;
+	l.end = buf + len;
+	l.window = LYNX_LINES_WINDOW(workers + 1);
+	l.chunks = (lynx_lines_chunk*)MALLOC(l.window * sizeof(lynx_lines_chunk));
+	for (i = 0; i < l.window; i++) {
+		l.chunks[i].results = NULL;
+		l.chunks[i].capacity = 0;
+	}
+	l.next = l.oldest = l.frontier = l.lines = 0;
+	l.stop = 0;
+	lynx_mutex_init(&l.mutex);
+	lynx_cond_init(&l.cond);
+#ifndef LYNX_NO_THREADS
+	if (workers) {
+		threads = (lynx_thread*)MALLOC(workers * sizeof(lynx_thread));
+		for (i = 0; i < workers; i++)
+			if (lynx_thread_create(&threads[i], lynx_lines_worker, &l) != 0) break;
+		workers = i;	//创建失败时用已有的线程继续
+	}
+#endif
+
+	lynx_worker_context_init(&c);
+	lynx_mutex_lock(&l.mutex);
+	for (;;) {
+		if ((k = lynx_lines_ready(&l, flags & LYNX_LINES_UNORDERED)) != NULL) {
+			int stop = l.stop;	//工作线程在锁中读取l.stop，交付期间只修改副本
+			lynx_mutex_unlock(&l.mutex);
+			for (i = 0; i < k->count; i++) {
+				lynx_line_result* r = &k->results[i];
+				if (!stop && fn(ctx, k->base + r->line + 1, r->ret, &r->v)) stop = 1;
+				else if (stop) lynx_free(&r->v);	//中止之后剩下的结果直接释放
+			}
+			lynx_mutex_lock(&l.mutex);
+			l.stop = stop;
+			k->delivered = 1;
+			while (l.oldest != l.next && LYNX_LINES_CHUNK(&l, l.oldest)->delivered)
+				l.oldest++;
+			lynx_cond_broadcast(&l.cond);
+		}
+		else if ((k = lynx_lines_take(&l)) != NULL) {
+			lynx_mutex_unlock(&l.mutex);
+			lynx_lines_parse_chunk(&l, k, &c);
+			lynx_mutex_lock(&l.mutex);
+		}
+		else if (l.oldest == l.next && (l.stop || l.pos == l.end))
+			break;
+		else
+			lynx_cond_wait(&l.cond, &l.mutex);
+	}
+	lynx_mutex_unlock(&l.mutex);
+
+#ifndef LYNX_NO_THREADS
+	for (i = 0; i < workers; i++)
+		lynx_thread_join(threads[i]);
+	if (threads) FREE(threads);
+#endif
+	if (c.stack) FREE(c.stack);
+	for (i = 0; i < l.window; i++)
+		if (l.chunks[i].results) FREE(l.chunks[i].results);
+	FREE(l.chunks);
+	lynx_cond_destroy(&l.cond);
+	lynx_mutex_destroy(&l.mutex);
+	return l.stop ? LYNX_PARSE_TERMINATED : LYNX_PARSE_OK;
+}
+
+lynx_document* lynx_document_create(void)
+{
+	return lynx_document_create_ex(NULL);
+}
+
+lynx_document* lynx_document_create_ex(const lynx_allocator* a)
+{
+	lynx_document* doc;
+	if (!a) a = &lynx_global_allocator;
+	doc = (lynx_document*)LYNX_MALLOC(a, sizeof(lynx_document));
+	doc->allocator = *a;
+	lynx_init(&doc->root);
+	doc->chunks = NULL;
+	doc->blocks = NULL;
+	doc->cur = doc->end = NULL;
+	doc->next_size = LYNX_ARENA_CHUNK_SIZE;
+	doc->stack = NULL;
+	doc->stack_size = 0;
+	doc->keys = NULL;
+	return doc;
+}
+
+void lynx_document_set_key_table(lynx_document* doc, lynx_key_table* t)
+{
+	assert(doc != NULL);
+	doc->keys = t;
+}
+
+//释放文档之前的内容，arena保留一块供后续使用；节点的存储空间都在arena或文档记录的内存块中，不需要遍历
+static void lynx_document_clear(lynx_document* doc)
+{
+	lynx_document_release_all(doc);
+	lynx_arena_reset(doc);
+	lynx_init(&doc->root);
+}
+
+void lynx_document_destroy(lynx_document* doc)
+{
+	if (!doc) return;
+	lynx_document_release_all(doc);
+	while (doc->chunks) {
+		lynx_arena_chunk* next = doc->chunks->next;
+		LYNX_FREE(&doc->allocator, doc->chunks);
+		doc->chunks = next;
+	}
+	if (doc->stack) LYNX_FREE(&doc->allocator, doc->stack);
+	LYNX_FREE(&doc->allocator, doc);
+}
+
+static int lynx_document_parse_buffer(lynx_document* doc, const char* json, int insitu)
+{
+	lynx_context c;
+	int ret;
+	assert(doc != NULL && json != NULL);
+	lynx_document_clear(doc);
+	c.json = json;
+	c.end = c.limit = json + strlen(json);
+	c.stack = doc->stack;
+	c.size = doc->stack_size;
+	c.top = 0;
+	c.allocator = &doc->allocator;
+	c.insitu = insitu;
+	c.max_depth = LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c.doc = doc;
+	c.keys = doc->keys;
+	c.write = NULL;
+	ret = lynx_parse_root(&c, &doc->root);
+	doc->stack = c.stack;
+	doc->stack_size = c.size;
+	//解析失败时已经分配的arena内存没有用处了
+	if (ret != LYNX_PARSE_OK) lynx_arena_reset(doc);
+	return ret;
+}
+
+int lynx_document_parse(lynx_document* doc, const char* json)
+{
+	return lynx_document_parse_buffer(doc, json, 0);
+}
+
+int lynx_document_parse_insitu(lynx_document* doc, char* json)
+{
+	return lynx_document_parse_buffer(doc, json, 1);
+}
+
+lynx_value* lynx_document_root(lynx_document* doc)
+{
+	assert(doc);
+	return &doc->root;
+}
+
+/*
+增量（push）解析器
+	输入可以在任意位置切分（包括字面量、数字、字符串的中间），两次输入之间的状态保存在解析器中。
+	用显式的栈代替递归：frames记录每一层还没有结束的数组/对象，已经解析出的元素和成员与lynx_parse()一样暂存在解析栈中。
+	字面量、数字、字符串是仅有的多字节记号：完整位于本次输入中的记号直接交给lynx_parse_scalar()解析，
+	跨越两次输入的记号先复制到token缓冲区中，凑齐之后再解析，所以得到的节点和错误码都与lynx_parse()相同。
+	输入中的'\0'与lynx_parse()一样视为文本结束。
+*/
+enum {
+	LYNX_PUSH_VALUE,		//需要一个值：根节点、数组中','之后、对象中':'之后
+	LYNX_PUSH_ARRAY_FIRST,	//'['之后：值或']'
+	LYNX_PUSH_OBJECT_FIRST,	//'{'之后：键或'}'
+	LYNX_PUSH_KEY,			//对象中','之后
+	LYNX_PUSH_COLON,
+	LYNX_PUSH_AFTER_VALUE,	//数组/对象中的值之后：','或右括号
+	LYNX_PUSH_END,			//根节点已经结束，只允许空白
+	LYNX_PUSH_TOKEN,		//位于一个跨越输入的记号中间
+	LYNX_PUSH_DONE			//已经出错或者遇到了'\0'，忽略之后的输入
+};
+
+typedef struct lynx_push_frame {
+	lynx_type type;
+	size_t size;	//已经压入解析栈的元素/成员个数
+} lynx_push_frame;
+
+struct lynx_push_parser {
+	lynx_context c;
+	lynx_push_frame* frames;
+	size_t depth, frames_capacity;
+	int state;
+	int ret;				//LYNX_PUSH_DONE状态下的解析结果
+	char* token;			//跨越输入的记号，解析前以'\0'结尾
+	size_t token_len, token_capacity;
+	int token_key;			//记号是对象的键
+	int token_escape;		//字符串记号的最后一个字符是'\\'
+	lynx_value root;
+	lynx_allocator allocator;	//解析器本身、解析栈和token缓冲区使用的分配器
+};
+
+#define ISALPHA(ch) (((ch) >= 'a' && (ch) <= 'z') || ((ch) >= 'A' && (ch) <= 'Z'))
+#define ISNUMBERCHAR(ch) (ISDIGIT(ch) || (ch) == '-' || (ch) == '+' || (ch) == '.' || (ch) == 'e' || (ch) == 'E')
+
+lynx_push_parser* lynx_push_parser_create(void)
+{
+	return lynx_push_parser_create_ex(NULL);
+}
+
+lynx_push_parser* lynx_push_parser_create_ex(const lynx_parse_options* opt)
+{
+	const lynx_allocator* a = opt && opt->allocator ? opt->allocator : &lynx_global_allocator;
+	lynx_push_parser* pp = (lynx_push_parser*)LYNX_MALLOC(a, sizeof(lynx_push_parser));
+	pp->allocator = *a;
+	pp->c.stack = NULL;
+	pp->c.size = pp->c.top = 0;
+	pp->c.allocator = &pp->allocator;
+	pp->c.insitu = 0;
+	pp->c.max_depth = opt && opt->max_depth ? opt->max_depth : LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	pp->c.doc = NULL;
+	pp->c.keys = opt ? opt->keys : NULL;
+	pp->c.write = NULL;
+	pp->frames = NULL;
+	pp->depth = pp->frames_capacity = 0;
+	pp->token = NULL;
+	pp->token_len = pp->token_capacity = 0;
+	pp->state = LYNX_PUSH_VALUE;
+	pp->ret = LYNX_PARSE_OK;
+	lynx_init(&pp->root);
+	return pp;
+}
+
+//释放还没有完成的节点，回到初始状态
+static void lynx_push_reset(lynx_push_parser* pp)
+{
+	while (pp->depth > 0) {
+		lynx_push_frame* f = &pp->frames[--pp->depth];
+		for (size_t i = 0; i < f->size; ++i) {
+			if (f->type == LYNX_ARRAY) {
+				lynx_free((lynx_value*)lynx_context_pop(&pp->c, sizeof(lynx_value)));
+			} else {
+				lynx_member* m = (lynx_member*)lynx_context_pop(&pp->c, sizeof(lynx_member));
+				lynx_free(&m->k);
+				lynx_free(&m->v);
+			}
+		}
+	}
+	assert(pp->c.top == 0);
+	lynx_free(&pp->root);
+	pp->token_len = 0;
+	pp->state = LYNX_PUSH_VALUE;
+	pp->ret = LYNX_PARSE_OK;
+}
+
+void lynx_push_parser_destroy(lynx_push_parser* pp)
+{
+	if (!pp) return;
+	lynx_push_reset(pp);
+	if (pp->c.stack) LYNX_FREE(&pp->allocator, pp->c.stack);
+	if (pp->frames) LYNX_FREE(&pp->allocator, pp->frames);
+	if (pp->token) LYNX_FREE(&pp->allocator, pp->token);
+	LYNX_FREE(&pp->allocator, pp);
+}
+
+static int lynx_push_error(lynx_push_parser* pp, int ret)
+{
+	lynx_push_reset(pp);
+	pp->state = LYNX_PUSH_DONE;
+	pp->ret = ret;
+	return ret;
+}
+
+//一个值（标量或者刚结束的数组/对象）解析完成，交给所在的容器
+static void lynx_push_value(lynx_push_parser* pp, lynx_value* v)
+{
+	lynx_push_frame* f;
+	if (pp->depth == 0) {
+		memcpy(&pp->root, v, sizeof(lynx_value));
+		pp->state = LYNX_PUSH_END;
+		return;
+	}
+	f = &pp->frames[pp->depth - 1];
+	if (f->type == LYNX_ARRAY) {
+		memcpy(lynx_context_push(&pp->c, sizeof(lynx_value)), v, sizeof(lynx_value));
+		++f->size;
+	} else {
+		//成员在解析键时已经压栈，值的子节点都已经出栈，所以它就在栈顶
+		lynx_member* m = (lynx_member*)(pp->c.stack + pp->c.top - sizeof(lynx_member));
+		memcpy(&m->v, v, sizeof(lynx_value));
+	}
+	pp->state = LYNX_PUSH_AFTER_VALUE;
+}
+
+static void lynx_push_open(lynx_push_parser* pp, lynx_type type)
+{
+	if (pp->depth == pp->frames_capacity) {
+		pp->frames_capacity = pp->frames_capacity ? pp->frames_capacity * 2 : 16;
+		pp->frames = (lynx_push_frame*)LYNX_REALLOC(&pp->allocator, pp->frames, pp->frames_capacity * sizeof(lynx_push_frame));
+	}
+	pp->frames[pp->depth].type = type;
+	pp->frames[pp->depth].size = 0;
+	++pp->depth;
+	pp->state = type == LYNX_ARRAY ? LYNX_PUSH_ARRAY_FIRST : LYNX_PUSH_OBJECT_FIRST;
+}
+
+static void lynx_push_close(lynx_push_parser* pp)
+{
+	lynx_push_frame* f = &pp->frames[--pp->depth];
+	lynx_value v;
+	lynx_init(&v);
+	if (f->type == LYNX_ARRAY)
+		lynx_context_pop_array(&pp->c, &v, f->size);
+	else
+		lynx_context_pop_object(&pp->c, &v, f->size);
+	lynx_push_value(pp, &v);
+}
+
+//处理记号之外的一个非空白字符（'\0'表示输入结束），记号的开头由调用者处理
+static int lynx_push_char(lynx_push_parser* pp, char ch)
+{
+	int array = pp->depth > 0 && pp->frames[pp->depth - 1].type == LYNX_ARRAY;
+	switch (pp->state) {
+		case LYNX_PUSH_ARRAY_FIRST:
+			if (ch == ']') {
+				lynx_push_close(pp);
+				return LYNX_PARSE_OK;
+			}
+			/* fall through */
+		case LYNX_PUSH_VALUE:
+			if (ch == '[' || ch == '{') {
+				if (pp->depth == pp->c.max_depth) return LYNX_PARSE_DEPTH_EXCEEDED;
+				lynx_push_open(pp, ch == '[' ? LYNX_ARRAY : LYNX_OBJECT);
+				return LYNX_PARSE_OK;
+			}
+			return ch == '\0' ? LYNX_PARSE_EXPECT_VALUE : LYNX_PARSE_INVALID_VALUE;
+		case LYNX_PUSH_OBJECT_FIRST:
+			if (ch == '}') {
+				lynx_push_close(pp);
+				return LYNX_PARSE_OK;
+			}
+			/* fall through */
+		case LYNX_PUSH_KEY:
+			return LYNX_PARSE_MISS_KEY;
+		case LYNX_PUSH_COLON:
+			if (ch != ':') return LYNX_PARSE_MISS_COLON;
+			pp->state = LYNX_PUSH_VALUE;
+			return LYNX_PARSE_OK;
+		case LYNX_PUSH_AFTER_VALUE:
+			if (ch == ',') {
+				pp->state = array ? LYNX_PUSH_VALUE : LYNX_PUSH_KEY;
+				return LYNX_PARSE_OK;
+			}
+			if (ch == (array ? ']' : '}')) {
+				lynx_push_close(pp);
+				return LYNX_PARSE_OK;
+			}
+			return array ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+		case LYNX_PUSH_END:
+			if (ch != '\0') return LYNX_PARSE_ROOT_NOT_SINGULAR;
+			pp->state = LYNX_PUSH_DONE;
+			pp->ret = LYNX_PARSE_OK;
+			return LYNX_PARSE_OK;
+		default:
+			assert(0);
+			return LYNX_PARSE_INVALID_VALUE;
+	}
+}
+
+//从c.json开始解析一个完整的记号：值，或者对象的键
+static int lynx_push_scalar(lynx_push_parser* pp, int key)
+{
+	lynx_value v;
+	int ret;
+	lynx_init(&v);
+	if (key) {
+		lynx_member m;
+		char* s;
+		size_t len;
+		if ((ret = lynx_parse_string_raw(&pp->c, &s, &len)) != LYNX_PARSE_OK) return ret;
+		//s可能指向解析栈，先复制再压栈
+		lynx_context_set_key(&pp->c, &m.k, s, len);
+		lynx_init(&m.v);
+		memcpy(lynx_context_push(&pp->c, sizeof(lynx_member)), &m, sizeof(lynx_member));
+		++pp->frames[pp->depth - 1].size;
+		pp->state = LYNX_PUSH_COLON;
+		return LYNX_PARSE_OK;
+	}
+	if ((ret = lynx_parse_scalar(&pp->c, &v)) != LYNX_PARSE_OK) return ret;
+	lynx_push_value(pp, &v);
+	return LYNX_PARSE_OK;
+}
+
+//在[p, end)中寻找记号的结尾，*done表示记号是否已经结束，返回记号之后的位置
+//字符串到没有转义的'\"'为止；字面量和数字取最长的一段可能的字符，多出来的部分交给lynx_push_char()报错
+//字符串用lynx_scan_string()跳到下一个'\"'或'\\'，控制字符同样跳过，留给lynx_parse_string_raw()报错
+static const char* lynx_push_scan_token(lynx_push_parser* pp, char kind, const char* p, const char* end, int* done)
+{
+	*done = 1;
+	if (kind == '\"') {
+		//上一块输入以'\\'结尾，跳过被转义的字符
+		if (pp->token_escape && p < end) {
+			pp->token_escape = 0;
+			++p;
+		}
+		while (p < end) {
+			p = lynx_scan_string(p, end, end);
+			if (p == end) break;
+			if (*p == '\"') return p + 1;
+			if (*p == '\\' && ++p == end) {
+				pp->token_escape = 1;
+				break;
+			}
+			++p;
+		}
+	} else if (ISALPHA(kind)) {
+		while (p < end && ISALPHA(*p)) ++p;
+		if (p < end) return p;
+	} else {
+		while (p < end && ISNUMBERCHAR(*p)) ++p;
+		if (p < end) return p;
+	}
+	*done = 0;
+	return end;
+}
+
+static void lynx_push_token_append(lynx_push_parser* pp, const char* p, size_t len)
+{
+	if (pp->token_len + len > pp->token_capacity) {
+		while (pp->token_len + len > pp->token_capacity)
+			pp->token_capacity = pp->token_capacity ? pp->token_capacity * 2 : 64;
+		pp->token = (char*)LYNX_REALLOC(&pp->allocator, pp->token, pp->token_capacity);
+	}
+	memcpy(pp->token + pp->token_len, p, len);
+	pp->token_len += len;
+}
+
+//token缓冲区中的记号已经凑齐（或者输入已经结束），解析它
+static int lynx_push_token_finish(lynx_push_parser* pp)
+{
+	int ret;
+	pp->c.json = pp->token;
+	pp->c.end = pp->c.limit = pp->token + pp->token_len;
+	if ((ret = lynx_push_scalar(pp, pp->token_key)) != LYNX_PARSE_OK) return ret;
+	//字面量/数字之后多取的字符一定是非法的
+	if (pp->c.json != pp->token + pp->token_len) {
+		ret = lynx_push_char(pp, *pp->c.json);
+		assert(ret != LYNX_PARSE_OK);
+		return ret;
+	}
+	pp->token_len = 0;
+	return LYNX_PARSE_OK;
+}
+
+static int lynx_push_run(lynx_push_parser* pp, const char* p, const char* end)
+{
+	int ret, done;
+	while (p < end) {
+		char ch = *p;
+		const char* q;
+		if (pp->state == LYNX_PUSH_TOKEN) {
+			q = lynx_push_scan_token(pp, *pp->token, p, end, &done);
+			lynx_push_token_append(pp, p, (size_t)(q - p));
+			if (!done) return LYNX_PARSE_OK;
+			p = q;
+			if ((ret = lynx_push_token_finish(pp)) != LYNX_PARSE_OK) return ret;
+			continue;
+		}
+		if (ISWS(ch)) {
+			++p;
+			continue;
+		}
+		if (((pp->state == LYNX_PUSH_VALUE || pp->state == LYNX_PUSH_ARRAY_FIRST) &&
+				(ch == '\"' || ch == 'n' || ch == 't' || ch == 'f' || ch == '-' || ISDIGIT(ch))) ||
+			((pp->state == LYNX_PUSH_KEY || pp->state == LYNX_PUSH_OBJECT_FIRST) && ch == '\"')) {
+			int key = pp->state == LYNX_PUSH_KEY || pp->state == LYNX_PUSH_OBJECT_FIRST;
+			pp->token_escape = 0;
+			q = lynx_push_scan_token(pp, ch, p + 1, end, &done);
+			if (done) {
+				//记号完整地位于本次输入中，直接解析；数字/字面量多取的字符留给下一轮循环
+				pp->c.json = p;
+				pp->c.end = pp->c.limit = end;
+				if ((ret = lynx_push_scalar(pp, key)) != LYNX_PARSE_OK) return ret;
+				p = pp->c.json;
+			} else {
+				pp->token_len = 0;
+				pp->token_key = key;
+				lynx_push_token_append(pp, p, (size_t)(end - p));
+				pp->state = LYNX_PUSH_TOKEN;
+				return LYNX_PARSE_OK;
+			}
+			continue;
+		}
+		if ((ret = lynx_push_char(pp, ch)) != LYNX_PARSE_OK) return ret;
+		++p;
+	}
+	return LYNX_PARSE_OK;
+}
+
+//输入结束：解析最后一个记号，然后按遇到'\0'处理
+static int lynx_push_end(lynx_push_parser* pp)
+{
+	int ret = LYNX_PARSE_OK;
+	if (pp->state == LYNX_PUSH_TOKEN)
+		ret = lynx_push_token_finish(pp);
+	if (ret == LYNX_PARSE_OK)
+		ret = lynx_push_char(pp, '\0');
+	if (ret != LYNX_PARSE_OK)
+		return lynx_push_error(pp, ret);
+	assert(pp->state == LYNX_PUSH_DONE);
+	return LYNX_PARSE_OK;
+}
+
+int lynx_push_parser_feed(lynx_push_parser* pp, const char* buf, size_t len)
+{
+	const char* z;
+	int ret;
+	assert(pp != NULL && (buf != NULL || len == 0));
+	if (pp->state == LYNX_PUSH_DONE) return pp->ret;
+	z = len > 0 ? (const char*)memchr(buf, '\0', len) : NULL;
+	if ((ret = lynx_push_run(pp, buf, z ? z : buf + len)) != LYNX_PARSE_OK)
+		return lynx_push_error(pp, ret);
+	return z ? lynx_push_end(pp) : LYNX_PARSE_OK;
+}
+
+int lynx_push_parser_finish(lynx_push_parser* pp, lynx_value* v)
+{
+	int ret;
+	assert(pp != NULL && v != NULL);
+	lynx_init(v);
+	if (pp->state != LYNX_PUSH_DONE) lynx_push_end(pp);
+	ret = pp->ret;
+	if (ret == LYNX_PARSE_OK) {
+		memcpy(v, &pp->root, sizeof(lynx_value));
+		lynx_init(&pp->root);
+	}
+	lynx_push_reset(pp);
+	return ret;
+}
+
+/*
+按需（lazy）访问
+	lynx_lazy_parse()只用括号和引号匹配检查整个文档的结构，不解码字符串和数字，也不创建节点。
+	lynx_lazy只记录一个值在输入中的位置，查找成员/元素时逐个跳过不需要的值，
+	只有真正读取的值才用lynx_parse_value()等函数完整地解析，所以错误（如非法的数字或转义）也在读取时才报告。
+*/
+#define ISLAZYSPECIAL(ch) ((ch) == '\"' || (ch) == '[' || (ch) == ']' || (ch) == '{' || (ch) == '}')
+
+//从v所在的位置开始解析
+static void lynx_lazy_context(lynx_context* c, const lynx_lazy* v)
+{
+	c->json = v->json;
+	c->end = c->limit = v->end;
+	c->stack = NULL;
+	c->size = c->top = 0;
+	c->allocator = &lynx_global_allocator;
+	c->insitu = 0;
+	c->max_depth = LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c->doc = NULL;
+	c->keys = NULL;
+	c->write = NULL;
+}
+
+//跳过*json处的一个值：字符串只找结尾的引号，数组和对象只匹配括号，其余的字符不检查
+static int lynx_lazy_skip(const char** json, const char* end)
+{
+	unsigned char object[(LYNX_PARSE_DEFAULT_MAX_DEPTH + 7) / 8];	//每一层是否是对象，按位存放
+	const char* p = *json;
+	size_t depth = 0;
+	int is_object;
+	do {
+		if (p == end) {
+			if (!depth) return LYNX_PARSE_EXPECT_VALUE;
+			is_object = object[(depth - 1) >> 3] & (1 << ((depth - 1) & 7));
+			return is_object ? LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+		}
+		switch (*p) {
+			case '\"':
+				++p;
+				while (1) {
+					p = lynx_scan_string(p, end, end);
+					if (p == end) return LYNX_PARSE_MISS_QUOTATION_MARK;
+					if (*p == '\"') break;
+					if (*p == '\\' && ++p == end) return LYNX_PARSE_MISS_QUOTATION_MARK;
+					++p;
+				}
+				++p;
+				break;
+			case '[':
+			case '{':
+				if (depth == LYNX_PARSE_DEFAULT_MAX_DEPTH) return LYNX_PARSE_DEPTH_EXCEEDED;
+				if (*p == '{')
+					object[depth >> 3] |= (unsigned char)(1 << (depth & 7));
+				else
+					object[depth >> 3] &= (unsigned char)~(1 << (depth & 7));
+				++depth;
+				++p;
+				break;
+			case ']':
+			case '}':
+				if (!depth) return LYNX_PARSE_INVALID_VALUE;
+				is_object = (object[(depth - 1) >> 3] & (1 << ((depth - 1) & 7))) != 0;
+				if (is_object != (*p == '}'))
+					return is_object ? LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+				--depth;
+				++p;
+				break;
+			default:
+				if (depth) {
+					//容器中的空白、分隔符、字面量和数字一起跳过
+					while (++p != end && !ISLAZYSPECIAL(*p));
+				} else {
+					//单独的字面量或数字，到分隔符为止
+					const char* q = p;
+					while (p != end && !ISWS(*p) && *p != ',' && *p != ']' && *p != '}') ++p;
+					if (p == q) return LYNX_PARSE_INVALID_VALUE;
+				}
+				break;
+		}
+	} while (depth);
+	*json = p;
+	return LYNX_PARSE_OK;
+}
+
+int lynx_lazy_parse(lynx_lazy* root, const char* json, size_t len)
+{
+	const char *end = json + len, *p;
+	int ret;
+	assert(root != NULL && (json != NULL || len == 0));
+	root->json = root->end = end;
+	p = json != end && ISWS(*json) ? lynx_skip_whitespace(json, end, end) : json;
+	if (p == end) return LYNX_PARSE_EXPECT_VALUE;
+	root->json = p;
+	if ((ret = lynx_lazy_skip(&p, end)) != LYNX_PARSE_OK) return ret;
+	if (p != end && ISWS(*p)) p = lynx_skip_whitespace(p, end, end);
+	return p == end ? LYNX_PARSE_OK : LYNX_PARSE_ROOT_NOT_SINGULAR;
+}
+
+lynx_type lynx_lazy_get_type(const lynx_lazy* v)
+{
+	assert(v != NULL && v->json != v->end);
+	switch (*v->json) {
+		case 'n':	return LYNX_NULL;
+		case 't':	return LYNX_TRUE;
+		case 'f':	return LYNX_FALSE;
+		case '\"':	return LYNX_STRING;
+		case '[':	return LYNX_ARRAY;
+		case '{':	return LYNX_OBJECT;
+		default:	return LYNX_NUMBER;
+	}
+}
+
+//跳过当前的值，以及之后的','，到达这一层的结尾（close）时返回LYNX_PARSE_NOT_FOUND
+static int lynx_lazy_next(lynx_context* c, char close)
+{
+	int ret;
+	if ((ret = lynx_lazy_skip(&c->json, c->end)) != LYNX_PARSE_OK) return ret;
+	lynx_parse_whitespace(c);
+	if (PEEK(c) == ',') {
+		++c->json;
+		lynx_parse_whitespace(c);
+		return LYNX_PARSE_OK;
+	}
+	if (PEEK(c) == close) return LYNX_PARSE_NOT_FOUND;
+	return close == ']' ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+}
+
+int lynx_lazy_find(const lynx_lazy* v, const char* key, size_t klen, lynx_lazy* out)
+{
+	lynx_context c;
+	char* s;
+	size_t len;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_OBJECT && out != NULL && (key != NULL || klen == 0));
+	lynx_lazy_context(&c, v);
+	++c.json;
+	lynx_parse_whitespace(&c);
+	if (PEEK(&c) == '}') return LYNX_PARSE_NOT_FOUND;
+	while (1) {
+		if (PEEK(&c) != '\"') {
+			ret = LYNX_PARSE_MISS_KEY;
+			break;
+		}
+		//没有转义的键直接指向输入，只有含转义的键才解码到栈中
+		if ((ret = lynx_parse_string_raw(&c, &s, &len)) != LYNX_PARSE_OK) break;
+		ret = len == klen && memcmp(s, key, klen) == 0;
+		lynx_parse_whitespace(&c);
+		if (PEEK(&c) != ':') {
+			ret = LYNX_PARSE_MISS_COLON;
+			break;
+		}
+		++c.json;
+		lynx_parse_whitespace(&c);
+		if (ret) {
+			out->json = c.json;
+			out->end = c.end;
+			ret = PEEK(&c) == '}' || PEEK(&c) == ',' || c.json == c.end ? LYNX_PARSE_INVALID_VALUE : LYNX_PARSE_OK;
+			break;
+		}
+		if ((ret = lynx_lazy_next(&c, '}')) != LYNX_PARSE_OK) break;
+	}
+	if (c.stack) FREE(c.stack);
+	return ret;
+}
+
+int lynx_lazy_get_element(const lynx_lazy* v, size_t index, lynx_lazy* out)
+{
+	lynx_context c;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_ARRAY && out != NULL);
+	lynx_lazy_context(&c, v);
+	++c.json;
+	lynx_parse_whitespace(&c);
+	if (PEEK(&c) == ']') return LYNX_PARSE_NOT_FOUND;
+	for (; index; --index) {
+		if ((ret = lynx_lazy_next(&c, ']')) != LYNX_PARSE_OK) return ret;
+	}
+	out->json = c.json;
+	out->end = c.end;
+	return PEEK(&c) == ']' || PEEK(&c) == ',' || c.json == c.end ? LYNX_PARSE_INVALID_VALUE : LYNX_PARSE_OK;
+}
+
+int lynx_lazy_get_value(const lynx_lazy* v, lynx_value* out)
+{
+	lynx_context c;
+	int ret;
+	assert(v != NULL && out != NULL);
+	lynx_lazy_context(&c, v);
+	lynx_init(out);
+	ret = lynx_parse_value(&c, out);
+	if (c.stack) FREE(c.stack);
+	return ret;
+}
+
+//解析字面量或数字，之后必须是分隔符
+static int lynx_lazy_scalar(const lynx_lazy* v, lynx_value* tmp)
+{
+	lynx_context c;
+	int ret;
+	lynx_lazy_context(&c, v);
+	lynx_init(tmp);
+	if ((ret = lynx_parse_scalar(&c, tmp)) != LYNX_PARSE_OK) return ret;
+	if (c.json != c.end && !ISWS(*c.json) && *c.json != ',' && *c.json != ']' && *c.json != '}')
+		return LYNX_PARSE_INVALID_VALUE;
+	return LYNX_PARSE_OK;
+}
+
+int lynx_lazy_get_boolean(const lynx_lazy* v, int* b)
+{
+	lynx_value tmp;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_TRUE || lynx_lazy_get_type(v) == LYNX_FALSE);
+	assert(b != NULL);
+	if ((ret = lynx_lazy_scalar(v, &tmp)) != LYNX_PARSE_OK) return ret;
+	*b = tmp.type == LYNX_TRUE;
+	return LYNX_PARSE_OK;
+}
+
+int lynx_lazy_get_number(const lynx_lazy* v, double* n)
+{
+	lynx_value tmp;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_NUMBER && n != NULL);
+	if ((ret = lynx_lazy_scalar(v, &tmp)) != LYNX_PARSE_OK) return ret;
+	*n = lynx_get_number(&tmp);
+	return LYNX_PARSE_OK;
+}
+
+int lynx_lazy_get_int64(const lynx_lazy* v, int64_t* i)
+{
+	lynx_value tmp;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_NUMBER && i != NULL);
+	if ((ret = lynx_lazy_scalar(v, &tmp)) != LYNX_PARSE_OK) return ret;
+	if (tmp.flags & LYNX_FLAG_UINT64) return LYNX_PARSE_NUMBER_TOO_BIG;
+	*i = lynx_get_int64(&tmp);
+	return LYNX_PARSE_OK;
+}
+
+//把[p, p + n)追加到buf的第*w个字节处，超出cap的部分只计入长度
+static void lynx_lazy_append(char* buf, size_t cap, size_t* w, const char* p, size_t n)
+{
+	if (*w < cap) memcpy(buf + *w, p, cap - *w < n ? cap - *w : n);
+	*w += n;
+}
+
+int lynx_lazy_get_string(const lynx_lazy* v, char* buf, size_t cap, const char** str, size_t* len)
+{
+	lynx_context c;
+	const char *p, *q;
+	char* s;
+	char esc[4];
+	size_t n, w = 0;
+	int ret;
+	assert(lynx_lazy_get_type(v) == LYNX_STRING && str != NULL && len != NULL && (buf != NULL || cap == 0));
+	p = v->json + 1;
+	q = lynx_scan_string(p, v->end, v->end);
+	if (q == v->end) return LYNX_PARSE_MISS_QUOTATION_MARK;
+	if (*q == '\"') {
+		//不含转义：lynx_parse_string_raw()直接返回输入中的位置，不会用到解析栈
+		lynx_lazy_context(&c, v);
+		if ((ret = lynx_parse_string_raw(&c, &s, len)) != LYNX_PARSE_OK) return ret;
+		*str = s;
+		return LYNX_PARSE_OK;
+	}
+	//含转义：与lynx_parse_string_raw()的处理相同，只是解码到调用者的缓冲区中，不申请内存
+	while (1) {
+		lynx_lazy_append(buf, cap, &w, p, (size_t)(q - p));
+		p = q;
+		if (p == v->end) return LYNX_PARSE_MISS_QUOTATION_MARK;
+		char ch = *p++;
+		if (ch == '\"') break;
+		if (ch != '\\') return LYNX_PARSE_INVALID_STRING_CHAR;
+		if (!(p = lynx_parse_escape(p, v->end, esc, &n, &ret))) return ret;
+		lynx_lazy_append(buf, cap, &w, esc, n);
+		q = lynx_scan_string(p, v->end, v->end);
+	}
+	*str = buf;
+	*len = w;
+	return w <= cap ? LYNX_PARSE_OK : LYNX_PARSE_BUFFER_TOO_SMALL;
+}
+
+/*
+两阶段解析与紧凑的tape文档（lynx_tape）
+	第一阶段用SIMD每次分类64个字节，求出所有结构字符、字符串开头的引号以及字面量和数字的第一个字符的位置（结构索引）。
+	字符串内部的区间由未被转义的引号的前缀异或求出，所以这一阶段没有逐字节的分支。
+	第二阶段按结构索引检查语法，把所有值依次写入一个连续的64位字（tape）数组，字符串统一存放在另一块缓冲区中：
+		每个字的高8位是标记，低56位是内容
+		'n' 't' 'f'		字面量
+		'l' 'u' 'd'		int64_t / uint64_t / double，值存放在下一个字中
+		'"'				字符串（对象的键也是），内容是它在字符串缓冲区中的位置，那里依次是长度（size_t）、内容和'\0'
+		'[' '{'			数组/对象的开始，内容是对应的结束字的位置，跳过整个数组/对象只需要一步
+		']' '}'			数组/对象的结束，内容是元素/成员的个数
+	对象中键和值交替出现。字面量、数字、字符串的解码仍然使用lynx_parse_literal()等函数，所以结果和错误码与lynx_parse()基本一致。
+*/
+#define LYNX_TAPE_TAG(w)		((char)((w) >> 56))
+#define LYNX_TAPE_PAYLOAD(w)	((w) & (((uint64_t)1 << 56) - 1))
+#define LYNX_TAPE_WORD(tag, payload)	((uint64_t)(unsigned char)(tag) << 56 | (uint64_t)(payload))
+
+struct lynx_tape {
+	uint64_t* words;
+	size_t size, capacity;
+	char* strings;	//字符串缓冲区
+	size_t strings_size, strings_capacity;
+	size_t* index;	//第一阶段的结构索引
+	size_t index_size, index_capacity;
+	size_t* open;	//第二阶段还没有结束的数组/对象：开始字的位置和已有的元素/成员个数，两个一组
+	size_t open_capacity;
+};
+
+lynx_tape* lynx_tape_create(void)
+{
+	lynx_tape* t = (lynx_tape*)MALLOC(sizeof(lynx_tape));
+	memset(t, 0, sizeof(lynx_tape));
+	return t;
+}
+
+void lynx_tape_destroy(lynx_tape* t)
+{
+	if (!t) return;
+	if (t->words) FREE(t->words);
+	if (t->strings) FREE(t->strings);
+	if (t->index) FREE(t->index);
+	if (t->open) FREE(t->open);
+	FREE(t);
+}
+
+//保证数组p还能容纳n个元素（每个元素size字节）
+static void* lynx_tape_reserve(void* p, size_t* capacity, size_t used, size_t n, size_t size)
+{
+	if (used + n > *capacity) {
+		size_t c = *capacity ? *capacity : 64;
+		while (used + n > c) c += c >> 1;
+		p = REALLOC(p, c * size);
+		*capacity = c;
+	}
+	return p;
+}
+
+static void lynx_tape_push(lynx_tape* t, uint64_t w)
+{
+	if (t->size == t->capacity)
+		t->words = (uint64_t*)lynx_tape_reserve(t->words, &t->capacity, t->size, 1, sizeof(uint64_t));
+	t->words[t->size++] = w;
+}
+
+//每一位变为它和它之前（低位）所有位的异或，即引号之间（包括开头的引号）的位为1
+static uint64_t lynx_prefix_xor(uint64_t x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+//求出被反斜杠转义的字符的位置：连续的反斜杠两两配对，奇数个时下一个字符被转义
+//prev_escaped记录上一块最后是否留下一个没有配对的反斜杠
+static uint64_t lynx_find_escaped(uint64_t backslash, uint64_t* prev_escaped)
+{
+	const uint64_t even = 0x5555555555555555u;
+	uint64_t follows_escape, odd_starts, even_series;
+	backslash &= ~*prev_escaped;	//被上一块转义的反斜杠不再转义别的字符
+	follows_escape = backslash << 1 | *prev_escaped;
+	//从奇数位开始的反斜杠序列加上它自己，进位会清掉整个序列并停在序列之后
+	odd_starts = backslash & ~even & ~follows_escape;
+	even_series = odd_starts + backslash;
+	*prev_escaped = even_series < odd_starts;
+	return (even ^ (even_series << 1)) & follows_escape;
+}
+
+//第一阶段：结构索引
+//输入在字符串中间结束时，最后一个字符串的开头仍在索引中，第二阶段解析它时会报告LYNX_PARSE_MISS_QUOTATION_MARK，
+//这样在它之前的语法错误能先被报告，与lynx_parse()一致
+static void lynx_tape_stage1(lynx_tape* t, const char* json, size_t len)
+{
+	uint64_t prev_escaped = 0, prev_in_string = 0, prev_pred = 1;	//输入的开头相当于在空白之后
+	uint64_t escaped, quote, in_string, op, pred, bits;
+	lynx_block b;
+	char tail[64];
+	size_t pos;
+	const char* p;
+	t->index_size = 0;
+	for (pos = 0; pos < len; pos += 64) {
+		p = json + pos;
+		if (len - pos < 64) {
+			//最后不足64字节的部分复制出来再分类，不会读到输入之外，补上的空白不会产生索引
+			memset(tail, ' ', sizeof(tail));
+			memcpy(tail, p, len - pos);
+			p = tail;
+		}
+		lynx_classify(p, &b);
+		escaped = lynx_find_escaped(b.backslash, &prev_escaped);
+		quote = b.quote & ~escaped;
+		in_string = lynx_prefix_xor(quote) ^ prev_in_string;
+		prev_in_string = (uint64_t)0 - (in_string >> 63);
+		op = b.op & ~in_string;
+		//字面量和数字从结构字符或空白之后的第一个字符开始
+		pred = op | (b.ws & ~in_string);
+		bits = op | (quote & in_string) | (((pred << 1) | prev_pred) & ~b.ws & ~b.op & ~b.quote & ~in_string);
+		prev_pred = pred >> 63;
+		t->index = (size_t*)lynx_tape_reserve(t->index, &t->index_capacity, t->index_size, 64, sizeof(size_t));
+		while (bits) {
+			t->index[t->index_size++] = pos + lynx_ctz64(bits);
+			bits &= bits - 1;
+		}
+	}
+}
+
+//把c->json处的字符串解码后存入字符串缓冲区
+static int lynx_tape_string(lynx_tape* t, lynx_context* c)
+{
+	char* s;
+	size_t len;
+	int ret;
+	if ((ret = lynx_parse_string_raw(c, &s, &len)) != LYNX_PARSE_OK) return ret;
+	t->strings = (char*)lynx_tape_reserve(t->strings, &t->strings_capacity, t->strings_size, sizeof(size_t) + len + 1, 1);
+	lynx_tape_push(t, LYNX_TAPE_WORD('\"', t->strings_size));
+	memcpy(t->strings + t->strings_size, &len, sizeof(size_t));
+	memcpy(t->strings + t->strings_size + sizeof(size_t), s, len);
+	t->strings[t->strings_size + sizeof(size_t) + len] = '\0';
+	t->strings_size += sizeof(size_t) + len + 1;
+	return LYNX_PARSE_OK;
+}
+
+//字面量、数字或字符串
+static int lynx_tape_scalar(lynx_tape* t, lynx_context* c)
+{
+	lynx_value v;
+	uint64_t bits;
+	int ret;
+	if (PEEK(c) == '\"') return lynx_tape_string(t, c);
+	lynx_init(&v);
+	if ((ret = lynx_parse_scalar(c, &v)) != LYNX_PARSE_OK) return ret;
+	switch (v.type) {
+		case LYNX_NULL:		lynx_tape_push(t, LYNX_TAPE_WORD('n', 0)); break;
+		case LYNX_TRUE:		lynx_tape_push(t, LYNX_TAPE_WORD('t', 0)); break;
+		case LYNX_FALSE:	lynx_tape_push(t, LYNX_TAPE_WORD('f', 0)); break;
+		default:
+			assert(v.type == LYNX_NUMBER);
+			lynx_tape_push(t, LYNX_TAPE_WORD(v.flags & LYNX_FLAG_INT64 ? 'l' : v.flags & LYNX_FLAG_UINT64 ? 'u' : 'd', 0));
+			memcpy(&bits, &v.u, sizeof(bits));
+			lynx_tape_push(t, bits);
+			break;
+	}
+	return LYNX_PARSE_OK;
+}
+
+//第二阶段：按结构索引检查语法并写入tape
+static int lynx_tape_stage2(lynx_tape* t, const char* json, size_t len)
+{
+	const size_t* idx = t->index;
+	size_t n = t->index_size, k = 0, depth = 0, start;
+	lynx_type type = LYNX_NULL;	//当前所在的一层
+	lynx_context c;
+	int ret = LYNX_PARSE_OK, key = 0;
+	char ch;
+	c.json = json;
+	c.end = c.limit = json + len;
+	c.stack = NULL;
+	c.size = c.top = 0;
+	c.allocator = &lynx_global_allocator;
+	c.insitu = 0;
+	c.max_depth = LYNX_PARSE_DEFAULT_MAX_DEPTH;
+	c.doc = NULL;
+	c.keys = NULL;
+	c.write = NULL;
+	t->size = t->strings_size = 0;
+//下一个结构字符，没有时视为'\0'
+#define TOKEN() (k < n ? json[idx[k]] : '\0')
+//解析字符串或值之后，下一个结构字符必须紧接在（空白之后）
+#define TOKEN_FOLLOWS() (lynx_parse_whitespace(&c), c.json == (k < n ? json + idx[k] : c.end))
+	while (1) {
+		if (key) {
+			if (TOKEN() != '\"') {
+				ret = LYNX_PARSE_MISS_KEY;
+				break;
+			}
+			c.json = json + idx[k++];
+			if ((ret = lynx_tape_string(t, &c)) != LYNX_PARSE_OK) break;
+			if (!TOKEN_FOLLOWS() || TOKEN() != ':') {
+				ret = LYNX_PARSE_MISS_COLON;
+				break;
+			}
+			++k;
+		}
+		ch = TOKEN();
+		if (ch == '[' || ch == '{') {
+			if (depth == c.max_depth) {
+				ret = LYNX_PARSE_DEPTH_EXCEEDED;
+				break;
+			}
+			t->open = (size_t*)lynx_tape_reserve(t->open, &t->open_capacity, 2 * depth, 2, sizeof(size_t));
+			t->open[2 * depth] = t->size;
+			t->open[2 * depth + 1] = 0;
+			++depth;
+			lynx_tape_push(t, LYNX_TAPE_WORD(ch, 0));
+			type = ch == '[' ? LYNX_ARRAY : LYNX_OBJECT;
+			++k;
+			key = type == LYNX_OBJECT;
+			if (TOKEN() != (ch == '[' ? ']' : '}')) continue;
+		} else {
+			if (k == n) {
+				ret = LYNX_PARSE_EXPECT_VALUE;
+				break;
+			}
+			if (ch == ']' || ch == '}' || ch == ',' || ch == ':') {
+				ret = LYNX_PARSE_INVALID_VALUE;
+				break;
+			}
+			c.json = json + idx[k++];
+			if ((ret = lynx_tape_scalar(t, &c)) != LYNX_PARSE_OK) break;
+			if (!TOKEN_FOLLOWS()) {
+				ret = type == LYNX_NULL ? LYNX_PARSE_ROOT_NOT_SINGULAR :
+					type == LYNX_ARRAY ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+				break;
+			}
+			if (type == LYNX_NULL) break;
+			++t->open[2 * depth - 1];
+		}
+
+		//一个值之后应该是','或者这一层的结尾
+		while (1) {
+			ch = TOKEN();
+			if (ch == ',') {
+				++k;
+				key = type == LYNX_OBJECT;
+				break;
+			}
+			if (ch != (type == LYNX_ARRAY ? ']' : '}')) {
+				ret = type == LYNX_ARRAY ? LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET : LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+				break;
+			}
+			++k;
+			--depth;
+			start = t->open[2 * depth];
+			t->words[start] |= t->size;
+			lynx_tape_push(t, LYNX_TAPE_WORD(ch, t->open[2 * depth + 1]));
+			if (!depth) {
+				type = LYNX_NULL;
+				break;
+			}
+			++t->open[2 * depth - 1];
+			type = LYNX_TAPE_TAG(t->words[t->open[2 * depth - 2]]) == '[' ? LYNX_ARRAY : LYNX_OBJECT;
+		}
+		if (ret != LYNX_PARSE_OK || type == LYNX_NULL) break;
+	}
+	if (ret == LYNX_PARSE_OK && k != n) ret = LYNX_PARSE_ROOT_NOT_SINGULAR;
+#undef TOKEN
+#undef TOKEN_FOLLOWS
+	if (c.stack) FREE(c.stack);
+	return ret;
+}
+
+int lynx_tape_parse(lynx_tape* t, const char* json, size_t len)
+{
+	int ret;
+	assert(t != NULL && (json != NULL || len == 0));
+	lynx_tape_stage1(t, json, len);
+	ret = lynx_tape_stage2(t, json, len);
+	if (ret != LYNX_PARSE_OK) {
+		//出错时tape中是一个null，各个访问接口仍然可以使用
+		t->size = t->strings_size = 0;
+		lynx_tape_push(t, LYNX_TAPE_WORD('n', 0));
+	}
+	return ret;
+}
+
+lynx_type lynx_tape_get_type(const lynx_tape* t, size_t i)
+{
+	assert(t != NULL && i < t->size);
+	switch (LYNX_TAPE_TAG(t->words[i])) {
+		case 'n':	return LYNX_NULL;
+		case 't':	return LYNX_TRUE;
+		case 'f':	return LYNX_FALSE;
+		case '\"':	return LYNX_STRING;
+		case '[':	return LYNX_ARRAY;
+		case '{':	return LYNX_OBJECT;
+		default:	return LYNX_NUMBER;
+	}
+}
+
+size_t lynx_tape_next(const lynx_tape* t, size_t i)
+{
+	assert(t != NULL && i < t->size);
+	switch (LYNX_TAPE_TAG(t->words[i])) {
+		case '[': case '{':	return (size_t)LYNX_TAPE_PAYLOAD(t->words[i]) + 1;
+		case 'l': case 'u': case 'd':	return i + 2;
+		default:	return i + 1;
+	}
+}
+
+size_t lynx_tape_end(const lynx_tape* t, size_t i)
+{
+	assert(t != NULL && i < t->size);
+	assert(LYNX_TAPE_TAG(t->words[i]) == '[' || LYNX_TAPE_TAG(t->words[i]) == '{');
+	return (size_t)LYNX_TAPE_PAYLOAD(t->words[i]);
+}
+
+int lynx_tape_get_boolean(const lynx_tape* t, size_t i)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_TRUE || lynx_tape_get_type(t, i) == LYNX_FALSE);
+	return LYNX_TAPE_TAG(t->words[i]) == 't';
+}
+
+//数字节点的值，与lynx_value中的存储方式相同
+static void lynx_tape_number(const lynx_tape* t, size_t i, lynx_value* v)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_NUMBER);
+	v->type = LYNX_NUMBER;
+	switch (LYNX_TAPE_TAG(t->words[i])) {
+		case 'l':	v->flags = LYNX_FLAG_INT64; break;
+		case 'u':	v->flags = LYNX_FLAG_UINT64; break;
+		default:	v->flags = 0; break;
+	}
+	memcpy(&v->u, &t->words[i + 1], sizeof(uint64_t));
+}
+
+double lynx_tape_get_number(const lynx_tape* t, size_t i)
+{
+	lynx_value v;
+	lynx_tape_number(t, i, &v);
+	return lynx_get_number(&v);
+}
+
+int lynx_tape_is_int64(const lynx_tape* t, size_t i)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_NUMBER);
+	return LYNX_TAPE_TAG(t->words[i]) == 'l';
+}
+
+int64_t lynx_tape_get_int64(const lynx_tape* t, size_t i)
+{
+	lynx_value v;
+	lynx_tape_number(t, i, &v);
+	return lynx_get_int64(&v);
+}
+
+uint64_t lynx_tape_get_uint64(const lynx_tape* t, size_t i)
+{
+	lynx_value v;
+	lynx_tape_number(t, i, &v);
+	return lynx_get_uint64(&v);
+}
+
+const char* lynx_tape_get_string(const lynx_tape* t, size_t i)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_STRING);
+	return t->strings + LYNX_TAPE_PAYLOAD(t->words[i]) + sizeof(size_t);
+}
+
+size_t lynx_tape_get_string_length(const lynx_tape* t, size_t i)
+{
+	size_t len;
+	assert(lynx_tape_get_type(t, i) == LYNX_STRING);
+	memcpy(&len, t->strings + LYNX_TAPE_PAYLOAD(t->words[i]), sizeof(size_t));
+	return len;
+}
+
+size_t lynx_tape_get_array_size(const lynx_tape* t, size_t i)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_ARRAY);
+	return (size_t)LYNX_TAPE_PAYLOAD(t->words[lynx_tape_end(t, i)]);
+}
+
+size_t lynx_tape_get_array_element(const lynx_tape* t, size_t i, size_t index)
+{
+	assert(index < lynx_tape_get_array_size(t, i));
+	for (i = i + 1; index; --index)
+		i = lynx_tape_next(t, i);
+	return i;
+}
+
+size_t lynx_tape_get_object_size(const lynx_tape* t, size_t i)
+{
+	assert(lynx_tape_get_type(t, i) == LYNX_OBJECT);
+	return (size_t)LYNX_TAPE_PAYLOAD(t->words[lynx_tape_end(t, i)]);
+}
+
+size_t lynx_tape_find_object_value(const lynx_tape* t, size_t i, const char* key, size_t klen)
+{
+	size_t end;
+	assert(lynx_tape_get_type(t, i) == LYNX_OBJECT && (key != NULL || klen == 0));
+	end = lynx_tape_end(t, i);
+	for (i = i + 1; i != end; i = lynx_tape_next(t, i + 1)) {
+		if (lynx_tape_get_string_length(t, i) == klen && memcmp(lynx_tape_get_string(t, i), key, klen) == 0)
+			return i + 1;
+	}
+	return LYNX_KEY_NOT_EXIST;
+}
+
+void lynx_tape_to_value(const lynx_tape* t, size_t i, lynx_value* v)
+{
+	size_t n, end;
+	assert(t != NULL && v != NULL && i < t->size);
+	lynx_init(v);
+	switch (LYNX_TAPE_TAG(t->words[i])) {
+		case 'n':	break;
+		case 't':	v->type = LYNX_TRUE; break;
+		case 'f':	v->type = LYNX_FALSE; break;
+		case '\"':	lynx_set_string(v, lynx_tape_get_string(t, i), lynx_tape_get_string_length(t, i)); break;
+		case '[':
+			end = lynx_tape_end(t, i);
+			lynx_set_array(v, (size_t)LYNX_TAPE_PAYLOAD(t->words[end]));
+			for (i = i + 1; i != end; i = lynx_tape_next(t, i))
+				lynx_tape_to_value(t, i, lynx_pushback_array_element(v));
+			break;
+		case '{':
+			end = lynx_tape_end(t, i);
+			n = (size_t)LYNX_TAPE_PAYLOAD(t->words[end]);
+			lynx_set_object(v, n);
+			//与解析时一样保留重复的键，依次填入成员
+			for (i = i + 1; i != end; i = lynx_tape_next(t, i + 1)) {
+				lynx_member* m = &(v->u.m[v->size++]);
+				lynx_set_string_raw(&(m->k), lynx_tape_get_string(t, i), lynx_tape_get_string_length(t, i));
+				lynx_tape_to_value(t, i + 1, &(m->v));
+			}
+			if (n >= LYNX_OBJECT_INDEX_THRESHOLD)
+				lynx_build_object_index(v);
+			break;
+		default:
+			lynx_tape_number(t, i, v);
+			break;
+	}
+}
+
+/*
+顶层数组的并行解析
+	输入按字节平均分成n段，分三步：
+	1. 每段并行地分类（与lynx_tape的第一阶段相同），求出段中未转义的引号个数的奇偶，以及段开头不在/在字符串中两种情况下括号的层数变化。
+	   一个字符是否被转义只取决于它之前连续的反斜杠，所以每段可以独立地从开头向前数反斜杠。
+	2. 顺序累加，得到每段开头是否在字符串中、处于第几层。
+	3. 每段并行地找到段中第一个位于第一层的','，从它之后开始用lynx_parse_value()逐个解析元素，直到越过段尾的','或者数组的']'。
+	   元素归它前面的','所在的段，最后一个元素可以延伸到之后的段中。
+	各段停下和开始的位置首尾相接、数组之后只有空白时，拼接起来就是顺序解析的结果，这一点与第1、2步的推测是否正确无关；
+	否则（只有输入不合法时才会发生）释放已经解析的部分，重新顺序解析，因此错误码与lynx_parse_n_ex()完全相同。
+*/
+#ifndef LYNX_PARALLEL_MIN_SIZE
+#define LYNX_PARALLEL_MIN_SIZE (1024 * 1024)	//每个线程至少分到的字节数
+#endif
+
+#ifndef LYNX_NO_THREADS
+typedef struct {
+	const char* begin;
+	const char* end;
+	const char* origin;		//数组的'['，向前数反斜杠时不越过它
+	//第1步的结果
+	int parity;				//未转义的引号个数的奇偶
+	ptrdiff_t delta[2];		//段开头不在/在字符串中时，段中括号的层数变化
+	//第2步的结果
+	int in_string;
+	ptrdiff_t depth;
+	//第3步的结果
+	const char* first;		//第一个元素之前的','（第0段为'['），段中没有元素时为NULL
+	const char* stop;		//停下的位置：下一个元素之前的','，或者数组的']'
+	int ret;
+	lynx_context c;			//解析出的元素依次保存在解析栈中
+	size_t count;
+} lynx_split;
+
+#define LYNX_BRACKET_DELTA(ch) (((ch) == '[' || (ch) == '{') - ((ch) == ']' || (ch) == '}'))
+
+//段开头的字符是否被转义：它之前连续的反斜杠为奇数个
+static uint64_t lynx_split_escaped(const lynx_split* s)
+{
+	const char* p = s->begin;
+	while (p != s->origin && p[-1] == '\\') --p;
+	return (uint64_t)((s->begin - p) & 1);
+}
+
+//对段中的每个64字节块分类，in_string为块中在字符串中的位（以段开头不在字符串中计）
+#define LYNX_SPLIT_FOREACH_BLOCK(s, p, b, in_string, body) do { \
+	uint64_t prev_escaped_ = lynx_split_escaped(s), prev_in_string_ = 0, quote_; \
+	const char* block_; \
+	char tail_[64]; \
+	for (block_ = (s)->begin; block_ < (s)->end; block_ += 64) { \
+		p = block_; \
+		if ((s)->end - block_ < 64) { \
+			memset(tail_, ' ', sizeof(tail_)); \
+			memcpy(tail_, block_, (s)->end - block_); \
+			p = tail_; \
+		} \
+		lynx_classify(p, &b); \
+		quote_ = b.quote & ~lynx_find_escaped(b.backslash, &prev_escaped_); \
+		in_string = lynx_prefix_xor(quote_) ^ prev_in_string_; \
+		prev_in_string_ = (uint64_t)0 - (in_string >> 63); \
+		body \
+	} \
+} while(0)
+
+LYNX_THREAD_PROC(lynx_split_summarize, arg)
+{
+	lynx_split* s = (lynx_split*)arg;
+	const char* p;
+	lynx_block b;
+	uint64_t in_string = 0, bits;
+	unsigned i;
+	s->delta[0] = s->delta[1] = 0;
+	LYNX_SPLIT_FOREACH_BLOCK(s, p, b, in_string, {
+		for (bits = b.op; bits; bits &= bits - 1) {
+			i = lynx_ctz64(bits);
+			s->delta[(in_string >> i) & 1] += LYNX_BRACKET_DELTA(p[i]);
+		}
+	});
+	s->parity = (int)(in_string >> 63);
+	LYNX_THREAD_RETURN;
+}
+
+//段中第一个位于第一层的','，遇到数组的结尾或者没有时返回NULL
+static const char* lynx_split_first(const lynx_split* s)
+{
+	const char* p;
+	lynx_block b;
+	uint64_t in_string, flip = s->in_string ? ~(uint64_t)0 : 0, bits;
+	ptrdiff_t depth = s->depth;
+	unsigned i;
+	if (depth < 1) return NULL;
+	LYNX_SPLIT_FOREACH_BLOCK(s, p, b, in_string, {
+		for (bits = b.op & ~(in_string ^ flip); bits; bits &= bits - 1) {
+			i = lynx_ctz64(bits);
+			if (p[i] == ',' && depth == 1) return block_ + i;
+			if ((depth += LYNX_BRACKET_DELTA(p[i])) == 0) return NULL;
+		}
+	});
+	return NULL;
+}
+
+//从s->first之后开始逐个解析元素
+static void lynx_split_parse(lynx_split* s)
+{
+	lynx_context* c = &s->c;
+	lynx_value e;
+	c->json = s->first + 1;
+	lynx_parse_whitespace(c);
+	if (s->first == s->origin && PEEK(c) == ']') {	//空数组
+		s->stop = c->json;
+		return;
+	}
+	while (1) {
+		lynx_init(&e);
+		if ((s->ret = lynx_parse_value(c, &e)) != LYNX_PARSE_OK) break;
+		memcpy(lynx_context_push(c, sizeof(lynx_value)), &e, sizeof(lynx_value));
+		++s->count;
+		lynx_parse_whitespace(c);
+		if (PEEK(c) != ',' && PEEK(c) != ']') {
+			s->ret = LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+			break;
+		}
+		if (PEEK(c) == ']' || c->json >= s->end) {
+			s->stop = c->json;
 			break;
 		}
+		++c->json;
 		lynx_parse_whitespace(c);
 	}
-
-	//出错后善后处理,销毁之前存在栈中的读取的成员
-	for (size_t i = 0; i < size; ++i) {
-		lynx_member* m = lynx_context_pop(c, sizeof(lynx_member));
-		free(m->k); lynx_free(&m->v);
-	}
-	return ret;
 }
 
-//value = null / false / true / number /string /array /object
-static int lynx_parse_value(lynx_context* c, lynx_value* v)
+LYNX_THREAD_PROC(lynx_split_find_and_parse, arg)
 {
-	switch (*c->json) {
-		case '{':	return lynx_parse_object(c, v);
-		case '[':	return lynx_parse_array(c, v);
-		case 'n':   return lynx_parse_literal(c, v, "null", LYNX_NULL);
-		case 't':   return lynx_parse_literal(c, v, "true", LYNX_TRUE);
-		case 'f':   return lynx_parse_literal(c, v, "false", LYNX_FALSE);
-		case '\"':	return lynx_parse_string(c, v);
-		default:    return lynx_parse_number(c, v);
-		case '\0':  return LYNX_PARSE_EXPECT_VALUE;
-	}
+	lynx_split* s = (lynx_split*)arg;
+	if (s->first == NULL) s->first = lynx_split_first(s);
+	if (s->first) lynx_split_parse(s);
+	LYNX_THREAD_RETURN;
 }
+#endif
 
-int lynx_parse(lynx_value* v, const char* json)
+int lynx_parse_parallel(lynx_value* v, const char* json, size_t len, size_t nthreads, const lynx_parse_options* opt)
 {
-	lynx_context c;
-	int ret;
-	assert(v != NULL);
-	c.json = json;
-	c.stack = NULL;
-	c.size = c.top = 0;
+#ifndef LYNX_NO_THREADS
+	lynx_split* splits;
+	const char *origin, *end = json + len, *next, *closed = NULL;
+	size_t i, j, n, total = 0, piece;
+	int in_string = 0, ok = 1;
+	ptrdiff_t depth = 1;
+	assert(v != NULL && json != NULL);
+	origin = json;
+	if (origin != end && ISWS(*origin)) origin = lynx_skip_whitespace(origin + 1, end, end);
+	n = nthreads ? nthreads : lynx_cpu_count();
+	if (n > len / LYNX_PARALLEL_MIN_SIZE) n = len / LYNX_PARALLEL_MIN_SIZE;
+	//键表不是线程安全的
+	if (n < 2 || origin == end || *origin != '[' || (opt && opt->keys))
+		return lynx_parse_n_ex(v, json, len, opt);
+
+	splits = (lynx_split*)MALLOC(n * sizeof(lynx_split));
+	piece = (size_t)(end - origin - 1) / n;
+	for (i = 0; i < n; i++) {
+		lynx_split* s = &splits[i];
+		s->begin = origin + 1 + i * piece;
+		s->end = i + 1 < n ? s->begin + piece : end;
+		s->origin = origin;
+		s->first = i == 0 ? origin : NULL;
+		s->stop = NULL;
+		s->ret = LYNX_PARSE_OK;
+		s->count = 0;
+		lynx_worker_context_init(&s->c);
+		s->c.end = end;
+		s->c.limit = end + (opt ? opt->padding : 0);
+		if (opt && opt->allocator) s->c.allocator = opt->allocator;
+		//元素比数组深一层
+		s->c.max_depth = (opt && opt->max_depth ? opt->max_depth : LYNX_PARSE_DEFAULT_MAX_DEPTH) - 1;
+	}
+	lynx_fork_join(lynx_split_summarize, splits, n, sizeof(lynx_split));
+	for (i = 0; i < n; i++) {
+		splits[i].in_string = in_string;
+		splits[i].depth = depth;
+		depth += splits[i].delta[in_string];
+		in_string ^= splits[i].parity;
+	}
+	lynx_fork_join(lynx_split_find_and_parse, splits, n, sizeof(lynx_split));
+
+	//检查各段是否首尾相接：next是下一个元素之前的','，它所在的段必须从这里开始
+	next = origin;
+	for (i = 0; i < n && ok; i++) {
+		lynx_split* s = &splits[i];
+		if (s->ret != LYNX_PARSE_OK) ok = 0;
+		else if (closed) ok = s->first == NULL;
+		else if (s->first) {
+			ok = s->first == next;
+			if (s->stop && *s->stop == ']') closed = s->stop;
+			else next = s->stop;
+		}
+		else ok = next >= s->end;
+	}
+	if (ok && closed) {
+		next = closed + 1;
+		if (next != end && ISWS(*next)) next = lynx_skip_whitespace(next + 1, end, end);
+		ok = next == end;
+	}
+	else
+		ok = 0;
+
 	lynx_init(v);
-	lynx_parse_whitespace(&c);
-	ret = lynx_parse_value(&c, v);
-	if (ret == LYNX_PARSE_OK) {
-		lynx_parse_whitespace(&c);
-		if (*c.json != '\0') {
-			lynx_set_null(v);
-			ret = LYNX_PARSE_ROOT_NOT_SINGULAR;
+	if (ok) {
+		for (i = 0; i < n; i++) total += splits[i].count;
+		lynx_set_array(v, total);
+		for (i = 0; i < n; i++) {
+			if (splits[i].count) memcpy(v->u.e + v->size, splits[i].c.stack, splits[i].count * sizeof(lynx_value));
+			v->size += (lynx_size)splits[i].count;
 		}
 	}
-	assert(c.top == 0);	//栈中不能有残留
-	free(c.stack);
-	return ret;
-	
+	for (i = 0; i < n; i++) {
+		lynx_split* s = &splits[i];
+		if (!ok)
+			for (j = 0; j < s->count; j++)
+				lynx_free((lynx_value*)s->c.stack + j);
+		if (s->c.stack) LYNX_FREE(s->c.allocator, s->c.stack);
+	}
+	FREE(splits);
+	return ok ? LYNX_PARSE_OK : lynx_parse_n_ex(v, json, len, opt);
+#else
+	(void)nthreads;
+	return lynx_parse_n_ex(v, json, len, opt);
+#endif
 }
 
 lynx_type lynx_get_type(const lynx_value* v)
@@ -426,6 +4471,8 @@ lynx_type lynx_get_type(const lynx_value* v)
 double lynx_get_number(const lynx_value* v)
 {
 	assert(v != NULL && v->type == LYNX_NUMBER);
+	if (v->flags & LYNX_FLAG_INT64) return (double)v->u.i64;
+	if (v->flags & LYNX_FLAG_UINT64) return (double)v->u.u64;
 	return v->u.n;
 }
 void lynx_set_number(lynx_value* v, double n)
@@ -436,61 +4483,126 @@ void lynx_set_number(lynx_value* v, double n)
 	v->type = LYNX_NUMBER;
 }
 
+int lynx_is_int64(const lynx_value* v)
+{
+	assert(v != NULL && v->type == LYNX_NUMBER);
+	return (v->flags & LYNX_FLAG_INT64) != 0;
+}
+
+int lynx_is_uint64(const lynx_value* v)
+{
+	assert(v != NULL && v->type == LYNX_NUMBER);
+	return (v->flags & LYNX_FLAG_UINT64) || ((v->flags & LYNX_FLAG_INT64) && v->u.i64 >= 0);
+}
+
+int64_t lynx_get_int64(const lynx_value* v)
+{
+	assert(v != NULL && v->type == LYNX_NUMBER);
+	assert(!(v->flags & LYNX_FLAG_UINT64));
+	if (v->flags & LYNX_FLAG_INT64) return v->u.i64;
+	return (int64_t)v->u.n;
+}
+
+uint64_t lynx_get_uint64(const lynx_value* v)
+{
+	assert(v != NULL && v->type == LYNX_NUMBER);
+	if (v->flags & LYNX_FLAG_UINT64) return v->u.u64;
+	if (v->flags & LYNX_FLAG_INT64) {
+		assert(v->u.i64 >= 0);
+		return (uint64_t)v->u.i64;
+	}
+	return (uint64_t)v->u.n;
+}
+
+void lynx_set_int64(lynx_value* v, int64_t i)
+{
+	assert(v);
+	lynx_free(v);
+	v->u.i64 = i;
+	v->flags = LYNX_FLAG_INT64;
+	v->type = LYNX_NUMBER;
+}
+
+void lynx_set_uint64(lynx_value* v, uint64_t u)
+{
+	assert(v);
+	lynx_free(v);
+	v->u.u64 = u;
+	v->flags = u > INT64_MAX ? LYNX_FLAG_UINT64 : LYNX_FLAG_INT64;	//INT64_MAX以内统一存为int64_t，便于比较
+	v->type = LYNX_NUMBER;
+}
+
 void lynx_free(lynx_value* v)
 {
 	assert(v);
 	switch(v->type) {
 		case LYNX_STRING:
-			free(v->u.s.s);
+			if (!(v->flags & (LYNX_FLAG_BORROWED | LYNX_FLAG_SHORT)))
+				lynx_node_free((v->flags & LYNX_FLAG_DOCUMENT) ? LYNX_DOCUMENT_OF(v->u.s) : NULL, v->u.s);
 			break;
 		case LYNX_ARRAY:
-			if (lynx_get_array_size(v) > 0) {
-				for (size_t i = 0; i < lynx_get_array_size(v); ++i)
-					lynx_free(lynx_get_array_element(v, i));
-				free(v->u.a.e);
-			}
+			for (size_t i = 0; i < lynx_get_array_size(v); ++i)
+				lynx_free(lynx_get_array_element(v, i));
+			if (!(v->flags & LYNX_FLAG_BORROWED) && v->u.e)
+				lynx_node_free(lynx_storage_document(v), lynx_storage(v));
 			break;
 		case LYNX_OBJECT:
-			if (lynx_get_object_size(v) > 0) {
-				for (size_t i = 0; i < lynx_get_object_size(v); ++i) {
-					free(v->u.o.m[i].k);
-					lynx_free(&(v->u.o.m[i].v));
-				}
-				free(v->u.o.m);
+			for (size_t i = 0; i < lynx_get_object_size(v); ++i) {
+				lynx_free(&(v->u.m[i].k));
+				lynx_free(&(v->u.m[i].v));
+			}
+			//arena中的对象的索引也在arena中
+			if (!(v->flags & LYNX_FLAG_BORROWED)) {
+				if ((v->flags & LYNX_FLAG_INDEXED) && LYNX_OBJECT_INDEX(v)->slots)
+					lynx_node_free(lynx_storage_document(v), LYNX_OBJECT_INDEX(v)->slots);
+				if (v->u.m)
+					lynx_node_free(lynx_storage_document(v), lynx_storage(v));
 			}
 			break;
 		default: break;
 	}
-	v->type = LYNX_NULL;
+	lynx_init(v);
 }
 
 
-static void lynx_set_string_raw(char** rs, size_t* rlen, const char* s, size_t len)
+//把s复制为v的字符串值（v不持有资源），短字符串直接存放在节点中
+static void lynx_set_string_raw(lynx_value* v, const char* s, size_t len)
 {
 	assert(s || len == 0);
-	memcpy(*rs = (char*)malloc(len + 1), s, len);
-	(*rs)[len] = '\0';
-	*rlen = len;
+	v->type = LYNX_STRING;
+	if (len <= LYNX_SHORT_STRING_MAX) {
+		char* p = (char*)v;
+		if (len > 0) memcpy(p, s, len);
+		p[len] = '\0';
+		p[LYNX_SHORT_STRING_MAX] = (char)(LYNX_SHORT_STRING_MAX - len);
+		v->flags = LYNX_FLAG_SHORT;
+	} else {
+		assert(len <= (lynx_size)-1);
+		v->u.s = (char*)MALLOC(len + 1);
+		memcpy(v->u.s, s, len);
+		v->u.s[len] = '\0';
+		v->size = (lynx_size)len;
+		v->flags = 0;
+	}
 }
 
 void lynx_set_string(lynx_value* v, const char* s, size_t len)
 {
 	assert(v);
 	lynx_free(v);
-	lynx_set_string_raw(&(v->u.s.s), &(v->u.s.len), s, len);
-	v->type = LYNX_STRING;
+	lynx_set_string_raw(v, s, len);
 }
 
 size_t lynx_get_string_length(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_STRING);
-	return v->u.s.len;
+	return LYNX_STRING_LENGTH(v);
 }
 
 const char* lynx_get_string(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_STRING);
-	return v->u.s.s;
+	return LYNX_STRING_DATA(v);
 }
 
 int lynx_get_boolean(const lynx_value* v)
@@ -509,76 +4621,339 @@ void lynx_set_boolean(lynx_value* v, int b)
 size_t lynx_get_array_size(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	return v->u.a.size;
+	return v->size;
 }
 
 lynx_value* lynx_get_array_element(const lynx_value* v, size_t index)
 {
-	assert(v && v->type == LYNX_ARRAY && index < v->u.a.size);
-	return v->u.a.e + index;
+	assert(v && v->type == LYNX_ARRAY && index < v->size);
+	return v->u.e + index;
 }
 
 size_t lynx_get_object_size(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	return v->u.o.size;
+	return v->size;
 }
 
 const char* lynx_get_object_key(const lynx_value* v, size_t index)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	assert(index < v->u.o.size);
-	return v->u.o.m[index].k;
+	assert(index < v->size);
+	return LYNX_KEY(&v->u.m[index]);
 }
 
 size_t lynx_get_object_key_length(const lynx_value* v, size_t index)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	assert(index < v->u.o.size);
-	return v->u.o.m[index].klen;
+	assert(index < v->size);
+	return LYNX_KEY_LENGTH(&v->u.m[index]);
 }
 
 lynx_value* lynx_get_object_value(const lynx_value* v, size_t index)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	assert(index < v->u.o.size);
-	return &(v->u.o.m[index].v);
+	assert(index < v->size);
+	return &(v->u.m[index].v);
+}
+
+//Grisu2算法使用的10的幂：10^k（k = -348, -340, ..., 340）的64位规格化近似值（四舍五入），10^k ≈ f * 2^e
+static const uint64_t lynx_cached_pow10_f[] = {
+	0xFA8FD5A0081C0288u, 0xBAAEE17FA23EBF76u, 0x8B16FB203055AC76u, 0xCF42894A5DCE35EAu,
+	0x9A6BB0AA55653B2Du, 0xE61ACF033D1A45DFu, 0xAB70FE17C79AC6CAu, 0xFF77B1FCBEBCDC4Fu,
+	0xBE5691EF416BD60Cu, 0x8DD01FAD907FFC3Cu, 0xD3515C2831559A83u, 0x9D71AC8FADA6C9B5u,
+	0xEA9C227723EE8BCBu, 0xAECC49914078536Du, 0x823C12795DB6CE57u, 0xC21094364DFB5637u,
+	0x9096EA6F3848984Fu, 0xD77485CB25823AC7u, 0xA086CFCD97BF97F4u, 0xEF340A98172AACE5u,
+	0xB23867FB2A35B28Eu, 0x84C8D4DFD2C63F3Bu, 0xC5DD44271AD3CDBAu, 0x936B9FCEBB25C996u,
+	0xDBAC6C247D62A584u, 0xA3AB66580D5FDAF6u, 0xF3E2F893DEC3F126u, 0xB5B5ADA8AAFF80B8u,
+	0x87625F056C7C4A8Bu, 0xC9BCFF6034C13053u, 0x964E858C91BA2655u, 0xDFF9772470297EBDu,
+	0xA6DFBD9FB8E5B88Fu, 0xF8A95FCF88747D94u, 0xB94470938FA89BCFu, 0x8A08F0F8BF0F156Bu,
+	0xCDB02555653131B6u, 0x993FE2C6D07B7FACu, 0xE45C10C42A2B3B06u, 0xAA242499697392D3u,
+	0xFD87B5F28300CA0Eu, 0xBCE5086492111AEBu, 0x8CBCCC096F5088CCu, 0xD1B71758E219652Cu,
+	0x9C40000000000000u, 0xE8D4A51000000000u, 0xAD78EBC5AC620000u, 0x813F3978F8940984u,
+	0xC097CE7BC90715B3u, 0x8F7E32CE7BEA5C70u, 0xD5D238A4ABE98068u, 0x9F4F2726179A2245u,
+	0xED63A231D4C4FB27u, 0xB0DE65388CC8ADA8u, 0x83C7088E1AAB65DBu, 0xC45D1DF942711D9Au,
+	0x924D692CA61BE758u, 0xDA01EE641A708DEAu, 0xA26DA3999AEF774Au, 0xF209787BB47D6B85u,
+	0xB454E4A179DD1877u, 0x865B86925B9BC5C2u, 0xC83553C5C8965D3Du, 0x952AB45CFA97A0B3u,
+	0xDE469FBD99A05FE3u, 0xA59BC234DB398C25u, 0xF6C69A72A3989F5Cu, 0xB7DCBF5354E9BECEu,
+	0x88FCF317F22241E2u, 0xCC20CE9BD35C78A5u, 0x98165AF37B2153DFu, 0xE2A0B5DC971F303Au,
+	0xA8D9D1535CE3B396u, 0xFB9B7CD9A4A7443Cu, 0xBB764C4CA7A44410u, 0x8BAB8EEFB6409C1Au,
+	0xD01FEF10A657842Cu, 0x9B10A4E5E9913129u, 0xE7109BFBA19C0C9Du, 0xAC2820D9623BF429u,
+	0x80444B5E7AA7CF85u, 0xBF21E44003ACDD2Du, 0x8E679C2F5E44FF8Fu, 0xD433179D9C8CB841u,
+	0x9E19DB92B4E31BA9u, 0xEB96BF6EBADF77D9u, 0xAF87023B9BF0EE6Bu
+};
+static const int16_t lynx_cached_pow10_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+	-927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661,
+	-635, -608, -582, -555, -529, -502, -475, -449, -422, -396, -369,
+	-343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77,
+	-50, -24, 3, 30, 56, 83, 109, 136, 162, 189, 216,
+	242, 269, 295, 322, 348, 375, 402, 428, 455, 481, 508,
+	534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800,
+	827, 853, 880, 907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const uint64_t lynx_pow10_u64[] = {
+	1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+	10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+	1000000000000000u, 10000000000000000u, 100000000000000000u, 1000000000000000000u,
+	10000000000000000000u
+};
+
+//f * 2^e
+typedef struct {
+	uint64_t f;
+	int e;
+} lynx_diyfp;
+
+static lynx_diyfp lynx_diyfp_make(uint64_t f, int e)
+{
+	lynx_diyfp r;
+	r.f = f;
+	r.e = e;
+	return r;
+}
+
+//乘积取高64位并四舍五入
+static lynx_diyfp lynx_diyfp_mul(lynx_diyfp a, lynx_diyfp b)
+{
+	uint64_t hi, lo = lynx_umul128(a.f, b.f, &hi);
+	return lynx_diyfp_make(hi + (lo >> 63), a.e + b.e + 64);
+}
+
+static lynx_diyfp lynx_diyfp_normalize(lynx_diyfp a)
+{
+	unsigned s = lynx_clz64(a.f);
+	return lynx_diyfp_make(a.f << s, a.e - (int)s);
+}
+
+//找到10^-K，使w * 10^-K的二进制指数落在[-60, -32]内
+static lynx_diyfp lynx_cached_pow10(int e, int* K)
+{
+	double dk = (-61 - e) * 0.30102999566398114 + 347;	//保证dk为正，向上取整
+	int k = (int)dk;
+	unsigned index;
+	if (dk - k > 0.0) ++k;
+	index = (unsigned)((k >> 3) + 1);
+	*K = -(-348 + (int)(index << 3));
+	return lynx_diyfp_make(lynx_cached_pow10_f[index], lynx_cached_pow10_e[index]);
+}
+
+//在不离开舍入区间的前提下，让末位数字尽量接近真实值
+static void lynx_grisu_round(char* buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+	while (rest < wp_w && delta - rest >= ten_kappa &&
+		(rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+		--buf[len - 1];
+		rest += ten_kappa;
+	}
+}
+
+//从区间上界mp开始逐位生成数字，直到剩余部分落入宽度为delta的区间内
+static int lynx_grisu_digit_gen(lynx_diyfp w, lynx_diyfp mp, uint64_t delta, char* buf, int* K)
+{
+	const lynx_diyfp one = lynx_diyfp_make((uint64_t)1 << -mp.e, mp.e);
+	const uint64_t wp_w = mp.f - w.f;
+	uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+	uint64_t p2 = mp.f & (one.f - 1);
+	int kappa = 1, len = 0;
+	while (kappa < 10 && p1 >= lynx_pow10_u64[kappa]) ++kappa;
+	while (kappa > 0) {
+		uint32_t d = (uint32_t)(p1 / lynx_pow10_u64[kappa - 1]);
+		uint64_t rest;
+		p1 %= (uint32_t)lynx_pow10_u64[kappa - 1];
+		if (d || len) buf[len++] = (char)('0' + d);
+		--kappa;
+		rest = ((uint64_t)p1 << -one.e) + p2;
+		if (rest <= delta) {
+			*K += kappa;
+			lynx_grisu_round(buf, len, delta, rest, lynx_pow10_u64[kappa] << -one.e, wp_w);
+			return len;
+		}
+	}
+	for (;;) {
+		char d;
+		p2 *= 10;
+		delta *= 10;
+		d = (char)(p2 >> -one.e);
+		if (d || len) buf[len++] = (char)('0' + d);
+		p2 &= one.f - 1;
+		--kappa;
+		if (p2 < delta) {
+			*K += kappa;
+			lynx_grisu_round(buf, len, delta, p2, one.f, -kappa < 20 ? wp_w * lynx_pow10_u64[-kappa] : 0);
+			return len;
+		}
+	}
+}
+
+//Grisu2：生成d（有限的正数）的最短（极少数情况下多一位）且能往返的十进制数字，d = buf * 10^K
+static int lynx_grisu2(double d, char* buf, int* K)
+{
+	uint64_t bits, f;
+	int be, e;
+	lynx_diyfp wp, wm, c;
+	memcpy(&bits, &d, sizeof(d));
+	be = (int)(bits >> 52) & 0x7FF;
+	f = bits & (((uint64_t)1 << 52) - 1);
+	if (be) {
+		f += (uint64_t)1 << 52;
+		e = be - 1075;
+	} else {
+		e = -1074;
+	}
+	//舍入区间的上下界：相邻两个double的中点。尾数为2的幂时下方间隔只有一半
+	wp = lynx_diyfp_normalize(lynx_diyfp_make((f << 1) + 1, e - 1));
+	wm = (f == ((uint64_t)1 << 52) && be > 1) ? lynx_diyfp_make((f << 2) - 1, e - 2) : lynx_diyfp_make((f << 1) - 1, e - 1);
+	wm.f <<= wm.e - wp.e;
+	wm.e = wp.e;
+	c = lynx_cached_pow10(wp.e, K);
+	wp = lynx_diyfp_mul(wp, c);
+	wm = lynx_diyfp_mul(wm, c);
+	++wm.f;	//近似乘法有1ulp误差，把区间向内收缩保证结果仍在区间内
+	--wp.f;
+	return lynx_grisu_digit_gen(lynx_diyfp_mul(lynx_diyfp_normalize(lynx_diyfp_make(f, e)), c), wp, wp.f - wm.f, buf, K);
+}
+
+//无符号整数转十进制，返回长度
+static size_t lynx_u64toa(uint64_t u, char* buf)
+{
+	char tmp[20];
+	size_t n = 0, i;
+	do {
+		tmp[n++] = (char)('0' + u % 10);
+		u /= 10;
+	} while (u);
+	for (i = 0; i < n; ++i)
+		buf[i] = tmp[n - 1 - i];
+	return n;
+}
+
+//按"%.17g"的格式排版buf中的len位数字（值为buf * 10^K）：十进制指数在[-4, 17)内用定点表示，否则用科学计数法
+static size_t lynx_format_decimal(char* buf, int len, int K)
+{
+	int exp10 = len + K - 1, n;
+	if (exp10 >= 0 && exp10 < 17) {
+		if (K >= 0) {
+			memset(buf + len, '0', (size_t)K);
+			return (size_t)(len + K);
+		}
+		memmove(buf + exp10 + 2, buf + exp10 + 1, (size_t)(len - exp10 - 1));
+		buf[exp10 + 1] = '.';
+		return (size_t)(len + 1);
+	}
+	if (exp10 < 0 && exp10 >= -4) {
+		int zeros = -exp10 - 1;
+		memmove(buf + 2 + zeros, buf, (size_t)len);
+		buf[0] = '0';
+		buf[1] = '.';
+		memset(buf + 2, '0', (size_t)zeros);
+		return (size_t)(len + 2 + zeros);
+	}
+	if (len > 1) {
+		memmove(buf + 2, buf + 1, (size_t)(len - 1));
+		buf[1] = '.';
+		n = len + 1;
+	} else {
+		n = 1;
+	}
+	buf[n++] = 'e';
+	if (exp10 < 0) {
+		buf[n++] = '-';
+		exp10 = -exp10;
+	} else {
+		buf[n++] = '+';
+	}
+	if (exp10 >= 100) {
+		buf[n++] = (char)('0' + exp10 / 100);
+		exp10 %= 100;
+	}
+	buf[n++] = (char)('0' + exp10 / 10);
+	buf[n++] = (char)('0' + exp10 % 10);
+	return (size_t)n;
+}
+
+#define LYNX_DTOA_BUFFER_SIZE 32
+
+//把double格式化为能精确往返的最短十进制串，返回长度，buf至少需要LYNX_DTOA_BUFFER_SIZE个字节
+static size_t lynx_dtoa(double d, char* buf)
+{
+	size_t n = 0;
+	int len, K;
+	if (!isfinite(d)) {
+		memcpy(buf, "null", 4);	//JSON无法表示NaN和无穷大，与JavaScript的JSON.stringify()一样输出null
+		return 4;
+	}
+	if (signbit(d)) {
+		buf[n++] = '-';
+		d = -d;
+	}
+	if (d < 9007199254740992.0 && d == (double)(uint64_t)d)	//2^53以内的整数
+		return n + lynx_u64toa((uint64_t)d, buf + n);
+	len = lynx_grisu2(d, buf + n, &K);
+	return n + lynx_format_decimal(buf + n, len, K);
 }
 
 #ifndef LYNX_PARSE_STRINGIFY_INIT_SIZE
 #define LYNX_PARSE_STRINGIFY_INIT_SIZE (1 << 8)
 #endif
-#define PUTS(c, s, len) memcpy(lynx_context_push(c, len), s, len)
 
-static int lynx_stringify_string(lynx_context* c, const char* s, size_t len)
+//需要转义的字符（'\"'、'\\'和控制字符）转义之后的第二个字符，'u'表示使用\u00XX，0表示不需要转义
+static const char lynx_escape_table[0x60] = {
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	0, 0, '\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+//输出一段不需要转义的文本：流式输出时整段直接交给输出函数，不经过缓冲区
+static void lynx_stringify_raw(lynx_context* c, const char* s, size_t len)
+{
+	if (c->write && c->top + len >= c->size) {
+		lynx_context_flush(c);
+		if (len >= c->size) {
+			if (!c->write_error && c->write(c->write_ctx, s, len))
+				c->write_error = 1;
+			return;
+		}
+	}
+	PUTS(c, s, len);
+}
+
+static void lynx_stringify_string(lynx_context* c, const char* s, size_t len)
 {
+	static const char hex[] = "0123456789ABCDEF";
+	const char* end = s + len;
+	const char* p;
+	unsigned char ch;
+	char* buf;
 	assert(s);
 	PUTC(c, '\"');
-	for (int i = 0; i < len; ++i) {
-		switch (s[i]) {
-			case '\"': PUTS(c, "\\\"", 2); break;
-			case '\\': PUTS(c, "\\\\", 2); break;
-			case '\b': PUTS(c, "\\b", 2);  break;
-			case '\f': PUTS(c, "\\f", 2);  break;
-			case '\n': PUTS(c, "\\n", 2);  break;
-			case '\r': PUTS(c, "\\r", 2);  break;
-			case '\t': PUTS(c, "\\t", 2);  break;
-			default:
-				if (s[i] >= 0x20) {
-					PUTC(c, s[i]);
-				} else {
-					char* buf = lynx_context_push(c, 7);
-					sprintf(buf, "\\u%04X", s[i]);
-					--c->top;
-				}
-				break;
+	while (1) {
+		//扫描函数找到的正是需要转义的字符，在此之前的部分整段复制
+		p = lynx_scan_string(s, end, end);
+		if (p != s) lynx_stringify_raw(c, s, (size_t)(p - s));
+		if (p == end) break;
+		ch = (unsigned char)*p;
+		buf = (char*)lynx_context_push(c, 2);
+		buf[0] = '\\';
+		buf[1] = lynx_escape_table[ch];
+		if (buf[1] == 'u') {
+			buf = (char*)lynx_context_push(c, 4);
+			buf[0] = '0';
+			buf[1] = '0';
+			buf[2] = hex[ch >> 4];
+			buf[3] = hex[ch & 0xF];
 		}
+		s = p + 1;
 	}
 	PUTC(c, '\"');
 }
 
-#define lynx_stringify_member(c, v, i) do { lynx_stringify_string((c), (v)->u.o.m[i].k, v->u.o.m[i].klen);\
-	PUTC((c), ':'); lynx_stringify_value((c), &((v)->u.o.m[i].v)); } while (0)
+#define lynx_stringify_member(c, v, i) do { lynx_stringify_string((c), LYNX_KEY(&(v)->u.m[i]), LYNX_KEY_LENGTH(&(v)->u.m[i]));\
+	PUTC((c), ':'); lynx_stringify_value((c), &((v)->u.m[i].v)); } while (0)
 
 static int lynx_stringify_value(lynx_context* c, const lynx_value* v)
 {
@@ -593,30 +4968,48 @@ static int lynx_stringify_value(lynx_context* c, const lynx_value* v)
 			PUTS(c, "false", 5);
 			break;
 		case LYNX_NUMBER:{
-			char* buffer = lynx_context_push(c, 32);
-			int len = sprintf(buffer, "%.17g", v->u.n);
-			c->top -= 32 - len;
+			//输出缓冲区大小固定时剩下的空间可能不够预留，先格式化到局部缓冲区
+			char local[LYNX_DTOA_BUFFER_SIZE];
+			int direct = !c->write || c->top + LYNX_DTOA_BUFFER_SIZE < c->size;
+			char* buffer = direct ? (char*)lynx_context_push(c, LYNX_DTOA_BUFFER_SIZE) : local;
+			size_t len;
+			if (v->flags & LYNX_FLAG_INT64) {
+				if (v->u.i64 < 0) {
+					*buffer = '-';
+					len = 1 + lynx_u64toa(0 - (uint64_t)v->u.i64, buffer + 1);
+				} else {
+					len = lynx_u64toa((uint64_t)v->u.i64, buffer);
+				}
+			} else if (v->flags & LYNX_FLAG_UINT64) {
+				len = lynx_u64toa(v->u.u64, buffer);
+			} else {
+				len = lynx_dtoa(v->u.n, buffer);
+			}
+			if (direct)
+				c->top -= LYNX_DTOA_BUFFER_SIZE - len;
+			else
+				PUTS(c, local, len);
 			break;
 		}
 		case LYNX_STRING:
-			lynx_stringify_string(c, v->u.s.s, v->u.s.len);
+			lynx_stringify_string(c, LYNX_STRING_DATA(v), LYNX_STRING_LENGTH(v));
 			break;
 		case LYNX_ARRAY:
 			PUTC(c, '[');
-			if (v->u.a.size > 0) {
-				lynx_stringify_value(c, &(v->u.a.e[0]));
-				for (int i = 1; i < v->u.a.size; ++i) {
+			if (v->size > 0) {
+				lynx_stringify_value(c, &(v->u.e[0]));
+				for (int i = 1; i < v->size; ++i) {
 					PUTC(c, ',');
-					lynx_stringify_value(c, &(v->u.a.e[i]));
+					lynx_stringify_value(c, &(v->u.e[i]));
 				}
 			}
 			PUTC(c, ']');
 			break;
 		case LYNX_OBJECT:
 			PUTC(c, '{');
-			if (v->u.o.size > 0) {
+			if (v->size > 0) {
 				lynx_stringify_member(c, v, 0);
-				for (int i = 1; i < v->u.o.size; ++i) {
+				for (int i = 1; i < v->size; ++i) {
 					PUTC(c, ',');
 					lynx_stringify_member(c, v, i);
 				}
@@ -631,15 +5024,23 @@ static int lynx_stringify_value(lynx_context* c, const lynx_value* v)
 }
 
 int lynx_stringify(const lynx_value* v, char** json, size_t* length)
+{
+	return lynx_stringify_ex(v, json, length, NULL);
+}
+
+int lynx_stringify_ex(const lynx_value* v, char** json, size_t* length, const lynx_allocator* a)
 {
 	assert(v);
 	assert(json);
 	lynx_context c;
 	int ret;
-	c.stack = (char*)malloc(c.size = LYNX_PARSE_STRINGIFY_INIT_SIZE);
+	c.allocator = a ? a : &lynx_global_allocator;
+	c.stack = (char*)LYNX_MALLOC(c.allocator, c.size = LYNX_PARSE_STRINGIFY_INIT_SIZE);
 	c.top = 0;
+	c.keys = NULL;
+	c.write = NULL;
 	if ((ret = lynx_stringify_value(&c, v)) != LYNX_STRINGIFY_OK) {
-		free(c.stack);
+		LYNX_FREE(c.allocator, c.stack);
 		*json = NULL;
 		return ret;
 	}
@@ -649,11 +5050,175 @@ int lynx_stringify(const lynx_value* v, char** json, size_t* length)
 	return LYNX_STRINGIFY_OK;
 }
 
+#ifndef LYNX_STRINGIFY_BUFFER_SIZE
+#define LYNX_STRINGIFY_BUFFER_SIZE (1 << 12)	//lynx_stringify_to()的输出缓冲区大小（字节），不能小于LYNX_DTOA_BUFFER_SIZE
+#endif
+
+int lynx_stringify_to(const lynx_value* v, lynx_write_fn write, void* ctx)
+{
+	assert(v);
+	assert(write);
+	char buffer[LYNX_STRINGIFY_BUFFER_SIZE];
+	lynx_context c;
+	int ret;
+	c.allocator = &lynx_global_allocator;
+	c.stack = buffer;
+	c.size = sizeof(buffer);
+	c.top = 0;
+	c.write = write;
+	c.write_ctx = ctx;
+	c.write_error = 0;
+	if ((ret = lynx_stringify_value(&c, v)) != LYNX_STRINGIFY_OK) return ret;
+	lynx_context_flush(&c);
+	return c.write_error ? LYNX_STRINGIFY_WRITE_ERROR : LYNX_STRINGIFY_OK;
+}
+
+//把buf全部写入文件描述符，被信号中断时重试
+static int lynx_write_fd(void* ctx, const char* buf, size_t len)
+{
+	int fd = *(const int*)ctx;
+	while (len) {
+#if defined(_WIN32)
+		int n = _write(fd, buf, (unsigned)(len < 0x40000000 ? len : 0x40000000));
+#else
+		ssize_t n = write(fd, buf, len);
+		if (n < 0 && errno == EINTR) continue;
+#endif
+		if (n <= 0) return -1;
+		buf += n;
+		len -= (size_t)n;
+	}
+	return 0;
+}
+
+int lynx_stringify_fd(const lynx_value* v, int fd)
+{
+	return lynx_stringify_to(v, lynx_write_fd, &fd);
+}
+
+//无符号整数的十进制位数
+static size_t lynx_u64_length(uint64_t u)
+{
+	size_t n = 1;
+	while (u >= 10) {
+		u /= 10;
+		++n;
+	}
+	return n;
+}
+
+//字符串输出后的长度（含两侧引号），转义规则与lynx_stringify_string()相同
+static size_t lynx_stringify_string_size(const char* s, size_t len)
+{
+	const char* end = s + len;
+	size_t n = len + 2;
+	while ((s = lynx_scan_string(s, end, end)) != end) {
+		n += lynx_escape_table[(unsigned char)*s] == 'u' ? 5 : 1;	//\u00XX或\X
+		++s;
+	}
+	return n;
+}
+
+size_t lynx_stringify_size(const lynx_value* v)
+{
+	char buffer[LYNX_DTOA_BUFFER_SIZE];
+	size_t n, i;
+	assert(v);
+	switch (v->type) {
+		case LYNX_NULL:		return 4;
+		case LYNX_TRUE:		return 4;
+		case LYNX_FALSE:	return 5;
+		case LYNX_NUMBER:
+			if (v->flags & LYNX_FLAG_INT64)
+				return v->u.i64 < 0 ? 1 + lynx_u64_length(0 - (uint64_t)v->u.i64) : lynx_u64_length((uint64_t)v->u.i64);
+			if (v->flags & LYNX_FLAG_UINT64)
+				return lynx_u64_length(v->u.u64);
+			return lynx_dtoa(v->u.n, buffer);
+		case LYNX_STRING:
+			return lynx_stringify_string_size(LYNX_STRING_DATA(v), LYNX_STRING_LENGTH(v));
+		case LYNX_ARRAY:
+			n = v->size ? v->size + 1 : 2;	//方括号和逗号
+			for (i = 0; i < v->size; ++i)
+				n += lynx_stringify_size(&v->u.e[i]);
+			return n;
+		case LYNX_OBJECT:
+			n = v->size ? 2 * v->size + 1 : 2;	//花括号、冒号和逗号
+			for (i = 0; i < v->size; ++i)
+				n += lynx_stringify_string_size(LYNX_KEY(&v->u.m[i]), LYNX_KEY_LENGTH(&v->u.m[i])) + lynx_stringify_size(&v->u.m[i].v);
+			return n;
+		default:
+			return 0;
+	}
+}
+
+/*
+lynx_stringify_into()直接把调用者的缓冲区作为输出缓冲区，输出不经过复制。
+	缓冲区写满时（输出函数第一次被调用）内容已经在原处，之后改用一小块临时缓冲区，输出函数只计算长度。
+	缓冲区太小时（连一次进栈都可能放不下）从一开始就使用临时缓冲区，由输出函数复制到调用者的缓冲区中。
+*/
+typedef struct {
+	lynx_context* c;
+	char* buf;
+	size_t cap, len;	//len是已经交给输出函数的长度
+	char scratch[2 * LYNX_DTOA_BUFFER_SIZE];
+} lynx_fixed_writer;
+
+static int lynx_write_fixed(void* ctx, const char* buf, size_t len)
+{
+	lynx_fixed_writer* w = (lynx_fixed_writer*)ctx;
+	if (buf != w->buf && w->len + len <= w->cap)
+		memcpy(w->buf + w->len, buf, len);
+	w->len += len;
+	if (w->c->stack == w->buf) {
+		w->c->stack = w->scratch;
+		w->c->size = sizeof(w->scratch);
+	}
+	return 0;
+}
+
+int lynx_stringify_into(const lynx_value* v, char* buf, size_t cap, size_t* length)
+{
+	lynx_fixed_writer w;
+	lynx_context c;
+	int ret;
+	assert(v);
+	assert(buf || cap == 0);
+	w.c = &c;
+	w.buf = buf;
+	w.cap = cap;
+	w.len = 0;
+	c.allocator = &lynx_global_allocator;
+	if (cap >= sizeof(w.scratch)) {
+		//进栈的条件是top + size < size，所以把容量看作cap + 1，缓冲区恰好能放下时也不会写满
+		c.stack = buf;
+		c.size = cap + 1;
+	} else {
+		c.stack = w.scratch;
+		c.size = sizeof(w.scratch);
+	}
+	c.top = 0;
+	c.write = lynx_write_fixed;
+	c.write_ctx = &w;
+	c.write_error = 0;
+	if ((ret = lynx_stringify_value(&c, v)) != LYNX_STRINGIFY_OK) return ret;
+	if (c.stack == buf)
+		w.len = c.top;
+	else
+		lynx_context_flush(&c);
+	if (length) *length = w.len;
+	if (w.len > cap) return LYNX_STRINGIFY_BUFFER_TOO_SMALL;
+	if (w.len < cap) buf[w.len] = '\0';
+	return LYNX_STRINGIFY_OK;
+}
+
 size_t lynx_find_object_index(const lynx_value* v, const char* key, size_t klen)
 {
 	assert(v && (v->type == LYNX_OBJECT) && key);
-	for (size_t i = 0; i < v->u.o.size; ++i) {
-		if (v->u.o.m[i].klen == klen && memcmp(v->u.o.m[i].k, key, klen) == 0)
+	if (v->flags & LYNX_FLAG_INDEXED)
+		return lynx_index_find(v, key, klen);
+	for (size_t i = 0; i < v->size; ++i) {
+		const char* k = LYNX_KEY(&v->u.m[i]);
+		if (LYNX_KEY_LENGTH(&v->u.m[i]) == klen && (k == key || memcmp(k, key, klen) == 0))
 			return i;
 	}
 	return LYNX_KEY_NOT_EXIST;
@@ -662,36 +5227,209 @@ size_t lynx_find_object_index(const lynx_value* v, const char* key, size_t klen)
 lynx_value* lynx_find_object_value(const lynx_value* v, const char* key, size_t klen)
 {
 	size_t index = lynx_find_object_index(v, key, klen);
-	return index != LYNX_KEY_NOT_EXIST ? &(v->u.o.m[index].v) : NULL;
+	return index != LYNX_KEY_NOT_EXIST ? &(v->u.m[index].v) : NULL;
+}
+
+/*
+编译好的JSON Pointer（RFC 6901）
+	编译时把路径拆成片段，解码~0和~1，预先算好每个片段的长度、哈希值和作为数组下标时的值，
+	求值时对带索引的对象直接用哈希值查找，对数组直接取下标，不再解析路径字符串。
+	片段和解码后的键都放在同一块内存中，lynx_path_free()一次释放。
+*/
+typedef struct {
+	const char* key;	//解码后的片段（不以'\0'结尾）
+	size_t klen;
+	uint32_t hash;		//lynx_hash_key(key, klen)
+	size_t index;		//作为数组下标的值，不是合法的下标时为LYNX_KEY_NOT_EXIST
+} lynx_path_segment;
+
+struct lynx_path {
+	size_t size;	//片段个数，0表示整个文档
+	lynx_path_segment segments[1];
+};
+
+//片段作为数组下标的值：只能是"0"或者不以0开头的十进制数
+static size_t lynx_path_index(const char* s, size_t len)
+{
+	size_t index = 0, i;
+	if (len == 0 || (len > 1 && s[0] == '0')) return LYNX_KEY_NOT_EXIST;
+	for (i = 0; i < len; ++i) {
+		if (!ISDIGIT(s[i]) || index > (LYNX_KEY_NOT_EXIST - 10) / 10) return LYNX_KEY_NOT_EXIST;
+		index = index * 10 + (size_t)(s[i] - '0');
+	}
+	return index;
+}
+
+lynx_path* lynx_path_compile(const char* pointer)
+{
+	size_t len, size = 0, i;
+	lynx_path* p;
+	lynx_path_segment* seg = NULL;
+	char* k;
+	assert(pointer);
+	len = strlen(pointer);
+	if (len && pointer[0] != '/') return NULL;
+	for (i = 0; i < len; ++i) {
+		if (pointer[i] == '/') ++size;
+		else if (pointer[i] == '~' && pointer[i + 1] != '0' && pointer[i + 1] != '1') return NULL;
+	}
+	p = (lynx_path*)MALLOC(sizeof(lynx_path) + size * sizeof(lynx_path_segment) + len);
+	p->size = size;
+	k = (char*)(p->segments + size + 1);	//解码后的键不会比路径长
+	for (i = 0; i < len; ++i) {
+		if (pointer[i] == '/') {
+			if (seg) seg->hash = lynx_hash_key(seg->key, seg->klen);
+			seg = seg ? seg + 1 : p->segments;
+			seg->key = k;
+			seg->klen = 0;
+			continue;
+		}
+		if (pointer[i] == '~')
+			*k++ = pointer[++i] == '0' ? '~' : '/';
+		else
+			*k++ = pointer[i];
+		++seg->klen;
+	}
+	if (seg) seg->hash = lynx_hash_key(seg->key, seg->klen);
+	for (i = 0; i < size; ++i)
+		p->segments[i].index = lynx_path_index(p->segments[i].key, p->segments[i].klen);
+	return p;
+}
+
+void lynx_path_free(lynx_path* p)
+{
+	if (p) FREE(p);
+}
+
+//沿一个片段走一步，没有对应的节点时返回NULL
+static lynx_value* lynx_path_step(const lynx_value* v, const lynx_path_segment* seg)
+{
+	size_t i;
+	if (v->type == LYNX_ARRAY)
+		return seg->index < v->size ? &(v->u.e[seg->index]) : NULL;
+	if (v->type != LYNX_OBJECT)
+		return NULL;
+	if (v->flags & LYNX_FLAG_INDEXED) {
+		i = lynx_index_find_hashed(v, seg->key, seg->klen, seg->hash);
+		return i != LYNX_KEY_NOT_EXIST ? &(v->u.m[i].v) : NULL;
+	}
+	for (i = 0; i < v->size; ++i) {
+		if (LYNX_KEY_LENGTH(&v->u.m[i]) == seg->klen && memcmp(LYNX_KEY(&v->u.m[i]), seg->key, seg->klen) == 0)
+			return &(v->u.m[i].v);
+	}
+	return NULL;
+}
+
+lynx_value* lynx_path_eval(const lynx_path* p, const lynx_value* root)
+{
+	lynx_value* v = (lynx_value*)root;
+	size_t i;
+	assert(p && root);
+	for (i = 0; i < p->size && v; ++i)
+		v = lynx_path_step(v, &p->segments[i]);
+	return v;
+}
+
+static int lynx_path_segment_equal(const lynx_path_segment* a, const lynx_path_segment* b)
+{
+	return a->hash == b->hash && a->klen == b->klen && memcmp(a->key, b->key, a->klen) == 0;
+}
+
+#ifndef LYNX_PATH_BATCH_DEPTH
+#define LYNX_PATH_BATCH_DEPTH 32	//lynx_path_eval_batch()不需要申请内存就能处理的路径深度
+#endif
+
+void lynx_path_eval_batch(const lynx_path* const* paths, size_t n, const lynx_value* root, lynx_value** out)
+{
+	//nodes[d]为上一条路径前d个片段对应的节点，与上一条路径相同的前缀不再重复查找
+	lynx_value* local[LYNX_PATH_BATCH_DEPTH + 1];
+	lynx_value** nodes = local;
+	const lynx_path* prev = NULL;
+	size_t depth = 0, i, d, common;
+	assert(paths && root && (out || n == 0));
+	for (i = 0; i < n; ++i)
+		if (paths[i]->size > depth) depth = paths[i]->size;
+	if (depth > LYNX_PATH_BATCH_DEPTH)
+		nodes = (lynx_value**)MALLOC((depth + 1) * sizeof(lynx_value*));
+	nodes[0] = (lynx_value*)root;
+	for (i = 0; i < n; ++i) {
+		const lynx_path* p = paths[i];
+		common = 0;
+		if (prev) {
+			while (common < p->size && common < prev->size && nodes[common + 1] &&
+				lynx_path_segment_equal(&p->segments[common], &prev->segments[common]))
+				++common;
+		}
+		for (d = common; d < p->size && nodes[d]; ++d)
+			nodes[d + 1] = lynx_path_step(nodes[d], &p->segments[d]);
+		for (; d < p->size; ++d)
+			nodes[d + 1] = NULL;
+		out[i] = nodes[p->size];
+		prev = p;
+	}
+	if (nodes != local) FREE(nodes);
+}
+
+//整数与double比较时不能把整数转为double（2^53以上会损失精度），只有double恰好是范围内的整数时才可能相等
+static int lynx_number_equal(const lynx_value* lhs, const lynx_value* rhs)
+{
+	const unsigned int_flags = LYNX_FLAG_INT64 | LYNX_FLAG_UINT64;
+	unsigned lf = lhs->flags & int_flags, rf = rhs->flags & int_flags;
+	double d;
+	if (lf && rf)	//INT64_MAX以内的值总是存为int64_t，所以存储方式不同就一定不相等
+		return lf == rf && lhs->u.u64 == rhs->u.u64;
+	if (!lf && !rf)
+		return lhs->u.n == rhs->u.n;	//与解析和输出一样按精确值比较：0与-0相等，NaN与任何值都不相等
+	if (lf) {
+		const lynx_value* t = lhs;
+		lhs = rhs;
+		rhs = t;
+	}
+	d = lhs->u.n;
+	if (rhs->flags & LYNX_FLAG_INT64)
+		return d >= -9223372036854775808.0 && d < 9223372036854775808.0 && d == (double)(int64_t)d && (int64_t)d == rhs->u.i64;
+	return d >= 0.0 && d < 18446744073709551616.0 && d == (double)(uint64_t)d && (uint64_t)d == rhs->u.u64;
 }
 
 int lynx_is_equal(const lynx_value* lhs, const lynx_value* rhs)
 {
+	size_t i;
 	assert(lhs && rhs);
+	//数字总是按值比较（NaN与自身也不相等）
+	if (lhs == rhs && lhs->type != LYNX_NUMBER) return 1;
 	if (lhs->type != rhs->type) return 0;
 	switch (lhs->type) {
 		case LYNX_STRING:
-			if (lhs->u.s.len != rhs->u.s.len) return 0;
-			return !memcmp(lhs->u.s.s, rhs->u.s.s, lhs->u.s.len);
+			if (LYNX_STRING_LENGTH(lhs) != LYNX_STRING_LENGTH(rhs)) return 0;
+			return !memcmp(LYNX_STRING_DATA(lhs), LYNX_STRING_DATA(rhs), LYNX_STRING_LENGTH(lhs));
 		case LYNX_ARRAY:
-			if (lhs->u.a.size != rhs->u.a.size) return 0;
-			for (size_t i = 0; i < lhs->u.a.size; ++i) {
-				if (!lynx_is_equal(&(lhs->u.a.e[i]), &(rhs->u.a.e[i])))
+			if (lhs->size != rhs->size) return 0;
+			if (lhs->u.e == rhs->u.e) return 1;
+			for (i = 0; i < lhs->size; ++i) {
+				if (!lynx_is_equal(&(lhs->u.e[i]), &(rhs->u.e[i])))
 					return 0;
 			}
 			return 1;
 			break;
-		case LYNX_OBJECT:	//由于对象成员在概念上是无序的，不能简单的顺序比较,在这里使用简单的算法（大量的性能消耗）
-			if (lhs->u.o.size != rhs->u.o.size) return 0;
-			for (size_t i = 0; i < lhs->u.o.size; ++i) {
-				lynx_value* rv = lynx_find_object_value(rhs, lhs->u.o.m[i].k, lhs->u.o.m[i].klen);
+		case LYNX_OBJECT:
+			if (lhs->size != rhs->size) return 0;
+			if (lhs->u.m == rhs->u.m) return 1;
+			//对象成员在概念上是无序的，但两边顺序相同是最常见的情况：先按位置比较，直到第一个键不同的成员
+			for (i = 0; i < lhs->size; ++i) {
+				const lynx_member *lm = &(lhs->u.m[i]), *rm = &(rhs->u.m[i]);
+				if (LYNX_KEY_LENGTH(lm) != LYNX_KEY_LENGTH(rm)) break;
+				if (LYNX_KEY(lm) != LYNX_KEY(rm) && memcmp(LYNX_KEY(lm), LYNX_KEY(rm), LYNX_KEY_LENGTH(lm)) != 0) break;
+				if (!lynx_is_equal(&(lm->v), &(rm->v))) return 0;
+			}
+			//剩下的成员按键查找。成员数达到LYNX_OBJECT_INDEX_THRESHOLD的对象都带有哈希索引，查找是O(1)的，整体为O(N)
+			for (; i < lhs->size; ++i) {
+				lynx_value* rv = lynx_find_object_value(rhs, LYNX_KEY(&lhs->u.m[i]), LYNX_KEY_LENGTH(&lhs->u.m[i]));
 				if (!rv) return 0;
-				if (!lynx_is_equal(&(lhs->u.o.m[i].v), rv)) return 0;
+				if (!lynx_is_equal(&(lhs->u.m[i].v), rv)) return 0;
 			}
 			return 1;
-			break;
 		case LYNX_NUMBER:
-			return fabs(lhs->u.n - rhs->u.n) < 1E-18;	//?
+			return lynx_number_equal(lhs, rhs);
 		default:
 			return 1;
 	}
@@ -703,24 +5441,26 @@ void lynx_copy(lynx_value* dst, const lynx_value* src)
 	lynx_free(dst);
 	switch (src->type) {
 		case LYNX_STRING:
-			lynx_set_string(dst, src->u.s.s, src->u.s.len);
+			lynx_set_string_raw(dst, LYNX_STRING_DATA(src), LYNX_STRING_LENGTH(src));
 			break;
 		case LYNX_ARRAY:
-			dst->type = LYNX_ARRAY;
-			dst->u.a.size = src->u.a.size;
-			dst->u.a.e = (lynx_value*)malloc(sizeof(lynx_value) * dst->u.a.size);
-			for (size_t i = 0; i < dst->u.a.size; ++i) {
-				lynx_copy(&(dst->u.a.e[i]), &(src->u.a.e[i]));
+			lynx_set_array(dst, src->size);
+			dst->size = src->size;
+			for (size_t i = 0; i < dst->size; ++i) {
+				lynx_init(&(dst->u.e[i]));
+				lynx_copy(&(dst->u.e[i]), &(src->u.e[i]));
 			}
 			break;
 		case LYNX_OBJECT:
-			dst->type = LYNX_OBJECT;
-			dst->u.o.size = dst->u.o.size;
-			dst->u.o.m = (lynx_member*)malloc(sizeof(lynx_member) * dst->u.o.size);
-			for (size_t i = 0; i < dst->u.o.size; ++i) {
-				lynx_set_string_raw(&(dst->u.o.m[i].k), &(dst->u.o.m[i].klen), src->u.o.m[i].k, src->u.o.m[i].klen);
-				lynx_copy(&(dst->u.o.m[i].v), &(src->u.o.m[i].v));
+			lynx_set_object(dst, src->size);
+			dst->size = src->size;
+			for (size_t i = 0; i < dst->size; ++i) {
+				lynx_set_string_raw(&(dst->u.m[i].k), LYNX_KEY(&src->u.m[i]), LYNX_KEY_LENGTH(&src->u.m[i]));
+				lynx_init(&(dst->u.m[i].v));
+				lynx_copy(&(dst->u.m[i].v), &(src->u.m[i].v));
 			}
+			if (src->flags & LYNX_FLAG_INDEXED)
+				lynx_build_object_index(dst);
 			break;
 		default:
 			memcpy(dst, src, sizeof(lynx_value));
@@ -752,95 +5492,128 @@ void lynx_swap(lynx_value* lhs, lynx_value* rhs)
 	memcpy(rhs, &tmp, sizeof(lynx_value));
 }
 
+//调整数组/对象存储空间的容量，容量头和索引头随元素/成员数组一起移动；不属于节点的存储空间（arena中）不能realloc，复制一份
+//属于文档的存储空间仍由文档记录，容量为0时也保留，以免丢失所属的文档
+static void lynx_resize_storage(lynx_value* v, size_t capacity)
+{
+	size_t elem = v->type == LYNX_ARRAY ? sizeof(lynx_value) : sizeof(lynx_member);
+	size_t index = v->type == LYNX_OBJECT && (v->flags & LYNX_FLAG_INDEXED) ? LYNX_INDEX_HEADER_SIZE : 0;
+	size_t header = LYNX_CAPACITY_HEADER_SIZE + index;
+	char *old = lynx_storage(v), *p = NULL;
+	lynx_document* doc = lynx_storage_document(v);
+	int borrowed = (v->flags & LYNX_FLAG_BORROWED) != 0;
+	assert(capacity >= v->size && capacity <= (lynx_size)-1);
+	if (borrowed) {
+		if (capacity > 0 || index || doc) {
+			p = (char*)lynx_node_alloc(doc, header + capacity * elem);
+			if (old) memcpy(p + LYNX_CAPACITY_HEADER_SIZE, old, index + v->size * elem);
+		}
+		v->flags &= ~LYNX_FLAG_BORROWED;
+	} else if (capacity > 0 || index || doc) {
+		p = (char*)(old ? lynx_node_realloc(doc, old, header + capacity * elem) : lynx_node_alloc(doc, header + capacity * elem));
+	} else if (old) {
+		//不依赖realloc(p, 0)的行为，用户提供的分配器不一定支持
+		FREE(old);
+	}
+	if (p) *(lynx_size*)p = (lynx_size)capacity;
+	if (v->type == LYNX_ARRAY)
+		v->u.e = p ? (lynx_value*)(p + header) : NULL;
+	else
+		v->u.m = p ? (lynx_member*)(p + header) : NULL;
+	//复制出来的对象不能再使用arena中的哈希表（它随arena一起释放）
+	if (borrowed && index) {
+		LYNX_OBJECT_INDEX(v)->slots = NULL;
+		lynx_index_rebuild(v);
+	}
+}
+
 void lynx_set_array(lynx_value* v, size_t capacity)
 {
 	assert(v);
 	lynx_free(v);
 	v->type = LYNX_ARRAY;
-	v->u.a.size = 0;
-	v->u.a.capacity = capacity;
-	v->u.a.e = capacity > 0 ? (lynx_value*)malloc(sizeof(lynx_value) * capacity) : NULL;
+	v->size = 0;
+	v->u.e = NULL;
+	if (capacity > 0) lynx_resize_storage(v, capacity);
 }
 
 size_t lynx_get_array_capacity(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	return v->u.a.capacity;
+	return lynx_storage_capacity(v);
 }
 
 void lynx_reserve_array(lynx_value* v, size_t capacity)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	if (capacity <= v->u.a.capacity) return;
-	v->u.a.e = (lynx_value*)realloc(v->u.a.e, capacity * sizeof(lynx_value));
-	v->u.a.capacity = capacity;
+	if (capacity <= lynx_storage_capacity(v)) return;
+	lynx_resize_storage(v, capacity);
 }
 
 void lynx_shrink_array(lynx_value* v)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	if (v->u.a.capacity > v->u.a.size) {
-		v->u.a.capacity = v->u.a.size;
-		v->u.a.e = (lynx_value*)realloc(v->u.a.e, v->u.a.size * sizeof(lynx_value));
-	}
+	if (lynx_storage_capacity(v) > v->size)
+		lynx_resize_storage(v, v->size);
 }
 
 lynx_value* lynx_pushback_array_element(lynx_value* v)
 {
+	size_t capacity;
 	assert(v && v->type == LYNX_ARRAY);
-	if (v->u.a.size == v->u.a.capacity) {
-		lynx_reserve_array(v, v->u.a.capacity == 0 ? 1 : v->u.a.capacity * 2);
+	if (v->size == (capacity = lynx_storage_capacity(v))) {
+		lynx_reserve_array(v, capacity == 0 ? 1 : capacity * 2);
 	}
-	lynx_init(&(v->u.a.e[v->u.a.size]));
-	return &(v->u.a.e[v->u.a.size++]);
+	lynx_init(&(v->u.e[v->size]));
+	return &(v->u.e[v->size++]);
 }
 
 void lynx_popback_array_element(lynx_value* v)
 {
-	assert(v && v->type == LYNX_ARRAY && v->u.a.size > 0);
-	lynx_free(&(v->u.a.e[--v->u.a.size]));
+	assert(v && v->type == LYNX_ARRAY && v->size > 0);
+	lynx_free(&(v->u.e[--v->size]));
 }
 
 void lynx_clear_array(lynx_value* v)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	for (size_t i = 0; i < v->u.a.size; ++i) {
-		lynx_free(&(v->u.a.e[i]));
+	for (size_t i = 0; i < v->size; ++i) {
+		lynx_free(&(v->u.e[i]));
 	}
-	v->u.a.size = 0;
+	v->size = 0;
 }
 
 lynx_value* lynx_insert_array_element(lynx_value* v, size_t index)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	assert(index <= v->u.a.size);
+	assert(index <= v->size);
 	lynx_pushback_array_element(v);
-	for (size_t i = v->u.a.size - 1; i > index; --i) {
-		memcpy(&(v->u.a.e[i]), &(v->u.a.e[i-1]), sizeof(lynx_value));
+	for (size_t i = v->size - 1; i > index; --i) {
+		memcpy(&(v->u.e[i]), &(v->u.e[i-1]), sizeof(lynx_value));
 	}
-	lynx_init(&(v->u.a.e[index]));
-	return &(v->u.a.e[index]);
+	lynx_init(&(v->u.e[index]));
+	return &(v->u.e[index]);
 }
 
 void lynx_erase_array_element(lynx_value* v, size_t index, size_t count)
 {
 	assert(v && v->type == LYNX_ARRAY);
-	assert(index + count <= v->u.a.size);
+	assert(index + count <= v->size);
 	if (count == 0) return;
 	for (size_t i = index; i < index + count; ++i) {
-		lynx_free(&(v->u.a.e[i]));
+		lynx_free(&(v->u.e[i]));
 	}
-	for (size_t i = index + count; i < v->u.a.size; ++i) {
-		memcpy(&(v->u.a.e[i - count]), &(v->u.a.e[i]), sizeof(lynx_value));
-		lynx_init(&(v->u.a.e[i]));
+	for (size_t i = index + count; i < v->size; ++i) {
+		memcpy(&(v->u.e[i - count]), &(v->u.e[i]), sizeof(lynx_value));
+		lynx_init(&(v->u.e[i]));
 	}
-	v->u.a.size -= count;
+	v->size -= count;
 }
 
 size_t lynx_get_object_capacity(const lynx_value* v)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	return v->u.o.capacity;
+	return lynx_storage_capacity(v);
 }
 
 void lynx_set_object(lynx_value* v, size_t capacity)
@@ -848,61 +5621,105 @@ void lynx_set_object(lynx_value* v, size_t capacity)
 	assert(v);
 	lynx_free(v);
 	v->type = LYNX_OBJECT;
-	v->u.o.size = 0;
-	v->u.o.capacity = capacity;
-	v->u.o.m = capacity > 0 ? (lynx_member*)malloc(sizeof(lynx_member) * capacity) : NULL;
+	v->size = 0;
+	v->u.m = NULL;
+	if (capacity > 0) lynx_resize_storage(v, capacity);
+}
+
+void lynx_build_object_index(lynx_value* v)
+{
+	assert(v && v->type == LYNX_OBJECT);
+	if (!(v->flags & LYNX_FLAG_INDEXED)) {
+		//在容量头和成员数组之间插入索引头
+		const size_t header = LYNX_CAPACITY_HEADER_SIZE + LYNX_INDEX_HEADER_SIZE;
+		size_t capacity = lynx_storage_capacity(v), used = v->size * sizeof(lynx_member);
+		char* p;
+		lynx_document* doc = lynx_storage_document(v);
+		if (v->flags & LYNX_FLAG_BORROWED) {
+			p = (char*)lynx_node_alloc(doc, header + capacity * sizeof(lynx_member));
+			if (used > 0) memcpy(p + header, v->u.m, used);
+			v->flags &= ~LYNX_FLAG_BORROWED;
+		} else {
+			char* old = lynx_storage(v);
+			p = (char*)(old ? lynx_node_realloc(doc, old, header + capacity * sizeof(lynx_member)) : lynx_node_alloc(doc, header + capacity * sizeof(lynx_member)));
+			if (used > 0) memmove(p + header, p + LYNX_CAPACITY_HEADER_SIZE, used);
+		}
+		*(lynx_size*)p = (lynx_size)capacity;
+		v->u.m = (lynx_member*)(p + header);
+		v->flags |= LYNX_FLAG_INDEXED;
+		LYNX_OBJECT_INDEX(v)->slots = NULL;
+	}
+	lynx_index_rebuild(v);
 }
 
 void lynx_reserve_object(lynx_value* v, size_t capacity)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	if (capacity <= v->u.o.capacity) return;
-	v->u.o.m = (lynx_member*)realloc(v->u.o.m, capacity * sizeof(lynx_member));
-	v->u.o.capacity = capacity;
+	if (capacity <= lynx_storage_capacity(v)) return;
+	lynx_resize_storage(v, capacity);
 }
 
 void lynx_shrink_object(lynx_value* v)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	if (v->u.o.capacity > v->u.o.size) {
-		v->u.o.capacity = v->u.o.size;
-		v->u.o.m = (lynx_member*)realloc(v->u.o.m, v->u.o.size * sizeof(lynx_member));
-	}
+	if (lynx_storage_capacity(v) > v->size)
+		lynx_resize_storage(v, v->size);
 }
 
 void lynx_remove_object_value(lynx_value* v, size_t index)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	assert(index < v->u.o.size);
-	free(v->u.o.m[index].k);
-	lynx_free(&(v->u.o.m[index].v));
-	for (size_t i = index + 1; i < v->u.o.size; ++i) {
-		memcpy(&(v->u.o.m[i-1]), &(v->u.o.m[i]), sizeof(lynx_member));
+	assert(index < v->size);
+	lynx_free(&(v->u.m[index].k));
+	lynx_free(&(v->u.m[index].v));
+	for (size_t i = index + 1; i < v->size; ++i) {
+		memcpy(&(v->u.m[i-1]), &(v->u.m[i]), sizeof(lynx_member));
 	}
-	--v->u.o.size;
+	--v->size;
+	//之后的成员下标都变了，反正移动成员已经是O(N)，直接重建索引
+	if (v->flags & LYNX_FLAG_INDEXED)
+		lynx_index_rebuild(v);
 }
 
 lynx_value* lynx_set_object_value(lynx_value* v, const char* key, size_t klen)
 {
 	assert(v && v->type == LYNX_OBJECT && key);
 	lynx_value* ret = lynx_find_object_value(v, key, klen);
+	size_t capacity;
 	if (ret) return ret;
-	if (v->u.o.size == v->u.o.capacity) {
-		lynx_reserve_object(v, v->u.o.capacity == 0 ? 1 : v->u.o.capacity * 2);
+	if (v->size == (capacity = lynx_storage_capacity(v))) {
+		lynx_reserve_object(v, capacity == 0 ? 1 : capacity * 2);
+	}
+	lynx_member* cur = &(v->u.m[v->size]);
+	if ((v->flags & LYNX_FLAG_DOCUMENT) && klen > LYNX_SHORT_STRING_MAX) {
+		//文档中的对象的键也由文档记录
+		assert(klen <= (lynx_size)-1);
+		cur->k.type = LYNX_STRING;
+		cur->k.flags = LYNX_FLAG_DOCUMENT;
+		cur->k.u.s = (char*)lynx_document_alloc(lynx_storage_document(v), klen + 1);
+		memcpy(cur->k.u.s, key, klen);
+		cur->k.u.s[klen] = '\0';
+		cur->k.size = (lynx_size)klen;
+	} else {
+		lynx_set_string_raw(&(cur->k), key, klen);
 	}
-	lynx_member* cur = &(v->u.o.m[v->u.o.size]);
-	lynx_set_string_raw(&(cur->k), &(cur->klen), key, klen);
 	lynx_init(&(cur->v));
-	++v->u.o.size;
-	return &(cur->v);
+	++v->size;
+	if (v->flags & LYNX_FLAG_INDEXED)
+		lynx_index_push(v);
+	else if (v->size >= LYNX_OBJECT_INDEX_THRESHOLD)
+		lynx_build_object_index(v);
+	return &(v->u.m[v->size - 1].v);
 }
 
 void lynx_clear_object(lynx_value* v)
 {
 	assert(v && v->type == LYNX_OBJECT);
-	for (size_t i = 0; i < v->u.o.size; ++i) {
-		free(v->u.o.m[i].k);
-		lynx_free(&(v->u.o.m[i].v));
+	for (size_t i = 0; i < v->size; ++i) {
+		lynx_free(&(v->u.m[i].k));
+		lynx_free(&(v->u.m[i].v));
 	}
-	v->u.o.size = 0;
+	v->size = 0;
+	if (v->flags & LYNX_FLAG_INDEXED)
+		lynx_index_rebuild(v);
 }
\ No newline at end of file
@@ -1,13 +1,14 @@
 #ifndef LYNXJSON_H__
 #define LYNXJSON_H__
 #include <stddef.h>	//size_t
+#include <stdint.h>	//int64_t, uint64_t
 
 //JSON值类型枚举
 typedef enum LYNX_TYPE {
 	LYNX_NULL,		//null
 	LYNX_FALSE,		//布尔值，false		
 	LYNX_TRUE,		//布尔值，true
-	LYNX_NUMBER,	//double
+	LYNX_NUMBER,	//数值，double或64位整数（见LYNX_FLAG_INT64）
 	LYNX_STRING,	//JSON字符串
 	LYNX_ARRAY,		//数组
 	LYNX_OBJECT,	//对象（字典）
@@ -18,21 +19,78 @@ typedef struct lynx_member lynx_member;
 //JSON值结构体
 typedef struct lynx_value lynx_value;
 
+//字符串的长度、数组的元素个数和对象的成员个数
+//编译选项中定义LYNX_COMPACT_SIZE时使用32位整数（单个字符串/数组/对象不能超过UINT32_MAX），lynx_value在64位平台上只占16字节
+#ifdef LYNX_COMPACT_SIZE
+typedef uint32_t lynx_size;
+#else
+typedef size_t lynx_size;
+#endif
+
 struct lynx_value {
-	lynx_type type;	//类型
 	union {
-		double n;											//LYNX_NUMBER
-		struct { char* s; size_t len; }s;					//LYNX_STRING
-		struct { lynx_value* e; size_t size, capacity; }a;	//LYNX_ARRAY
-		struct { lynx_member* m; size_t size, capacity; }o;	//LYNX_OBJECT
+		double n;			//LYNX_NUMBER
+		int64_t i64;		//LYNX_NUMBER（LYNX_FLAG_INT64）
+		uint64_t u64;		//LYNX_NUMBER（LYNX_FLAG_UINT64）
+		char* s;			//LYNX_STRING（短字符串见LYNX_FLAG_SHORT）
+		lynx_value* e;		//LYNX_ARRAY
+		lynx_member* m;		//LYNX_OBJECT
 	}u;
+	lynx_size size;			//字符串的长度/数组的元素个数/对象的成员个数，容量记录在存储空间中
+	char reserved[2];		//只用于存放短字符串
+	unsigned char flags;	//存储空间的所有权和数值的存储方式，见下面的LYNX_FLAG_*
+	unsigned char type;		//类型，见lynx_type
 };
 
+//对象的成员，键是一个LYNX_STRING节点（短的键同样直接存放在节点中）
 struct lynx_member {
-	char* k; size_t klen;	//JSON字符串
+	lynx_value k;
 	lynx_value v;
 };
 
+//短字符串的最大长度：节点在flags之前的字节依次存放内容和'\0'，不另外申请内存，64位平台上为17（LYNX_COMPACT_SIZE时为13）
+#define LYNX_SHORT_STRING_MAX (offsetof(lynx_value, flags) - 1)
+
+//lynx_value.flags
+#define LYNX_FLAG_BORROWED		0x1	//字符串/数组/对象的存储空间不属于该节点（位于原地解析的缓冲区或文档的arena中），lynx_free不会释放它
+#define LYNX_FLAG_SHORT			0x2	//短字符串，内容直接存放在节点中，见LYNX_SHORT_STRING_MAX
+#define LYNX_FLAG_INT64			0x4	//数值以int64_t存储在u.i64中
+#define LYNX_FLAG_UINT64		0x8	//数值以uint64_t存储在u.u64中，只用于大于INT64_MAX的值
+#define LYNX_FLAG_INDEXED		0x10	//对象带有哈希索引，见lynx_build_object_index()
+#define LYNX_FLAG_INTERNED		0x20	//对象的键引用键表中的副本（同时带有LYNX_FLAG_BORROWED），见lynx_key_table
+#define LYNX_FLAG_DOCUMENT		0x40	//存储空间属于某个文档（arena中或文档记录的内存块），销毁文档时一起释放，见lynx_document
+
+//内存分配器，库中所有的内存申请和释放都通过它进行，ud会原样传给各个函数
+typedef struct lynx_allocator {
+	void* (*malloc)(void* ud, size_t size);
+	void* (*realloc)(void* ud, void* ptr, size_t size);
+	void (*free)(void* ud, void* ptr);
+	void* ud;
+} lynx_allocator;
+
+//键表，见lynx_key_table_create()
+typedef struct lynx_key_table lynx_key_table;
+
+//lynx_parse_ex()的选项，全部置0表示使用默认值
+typedef struct lynx_parse_options {
+	const lynx_allocator* allocator;	//解析栈（临时内存）使用的分配器，NULL表示使用全局分配器
+	size_t padding;	//只用于lynx_parse_n_ex()：输入之后还可以安全读取的字节数（内容任意），见LYNX_PARSE_PADDING
+	size_t max_depth;	//数组/对象的最大嵌套层数，0表示LYNX_PARSE_DEFAULT_MAX_DEPTH
+	lynx_key_table* keys;	//不为NULL时，解析出的对象的键（短键除外）都引用键表中的副本，见lynx_key_table
+} lynx_parse_options;
+
+//没有指定max_depth时（以及没有选项参数的接口）允许的最大嵌套层数
+//解析不使用递归，这个限制只是为了拒绝恶意的深层嵌套，而不是保护调用栈
+#ifndef LYNX_PARSE_DEFAULT_MAX_DEPTH
+#define LYNX_PARSE_DEFAULT_MAX_DEPTH 1024
+#endif
+
+//输入之后有这么多填充字节时，SIMD扫描到结尾也可以整块读取，不必退回逐字节处理
+#define LYNX_PARSE_PADDING 32
+
+//JSON文档：解析出的所有字符串、数组、对象都从文档自己的arena中分配，销毁文档时整块释放
+typedef struct lynx_document lynx_document;
+
 //lynx_parse的返回值/错误标记,详情参见test.c查看示例
 enum LYNX_PARSE {
 	LYNX_PARSE_OK = 0,              		//解析成功
@@ -49,18 +107,177 @@ enum LYNX_PARSE {
 	LYNX_PARSE_MISS_COLON,					//对象中缺失冒号
 	LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET,	//对象中缺失右或括号或逗号
 	LYNX_PARSE_MISS_KEY,					//对象中的键值对缺失值
+	LYNX_PARSE_TERMINATED,					//SAX回调返回非0，解析被中止
+	LYNX_PARSE_FILE_ERROR,					//文件无法打开或读取
+	LYNX_PARSE_DEPTH_EXCEEDED,				//数组/对象的嵌套层数超过限制，见lynx_parse_options::max_depth
+	LYNX_PARSE_NOT_FOUND,					//lynx_lazy_find()/lynx_lazy_get_element()找不到对应的成员/元素
+	LYNX_PARSE_BUFFER_TOO_SMALL,			//lynx_lazy_get_string()的缓冲区放不下解码后的字符串
 };
 
 enum LYNX_STRINGIFY {
 	LYNX_STRINGIFY_OK,
 	LYNX_STRINGIFY_ERROR,
+	LYNX_STRINGIFY_WRITE_ERROR,	//lynx_stringify_to()的输出函数返回了非0
+	LYNX_STRINGIFY_BUFFER_TOO_SMALL,	//lynx_stringify_into()的缓冲区放不下输出
 };
 
 //初始化节点（将节点的类型设为空）
-#define lynx_init(v) do { (v)->type = LYNX_NULL; } while(0)
+#define lynx_init(v) do { (v)->type = LYNX_NULL; (v)->flags = 0; } while(0)
+
+//设置全局分配器，传入NULL恢复为标准库的malloc/realloc/free
+//节点的存储空间总是来自全局分配器，因此必须在创建任何节点之前设置，并且不能在其他线程使用本库时修改
+void lynx_set_allocator(const lynx_allocator* a);
+const lynx_allocator* lynx_get_allocator(void);
 
 //解析JSON文本，存入用户提供的节点
 int lynx_parse(lynx_value* v, const char* json);
+//同lynx_parse()，opt可以为NULL
+int lynx_parse_ex(lynx_value* v, const char* json, const lynx_parse_options* opt);
+//解析[json, json + len)中的JSON文本，不需要'\0'结尾，也不会读取json + len之后的内容（除非opt->padding不为0）
+//范围内的'\0'按普通字符处理（都是非法的）
+int lynx_parse_n(lynx_value* v, const char* json, size_t len);
+int lynx_parse_n_ex(lynx_value* v, const char* json, size_t len, const lynx_parse_options* opt);
+
+//原地解析：字符串和对象的键直接在json缓冲区中解码（会改写缓冲区的内容），节点引用缓冲区而不再复制一份
+//在v被释放之前，json缓冲区必须一直有效
+int lynx_parse_insitu(lynx_value* v, char* json);
+
+//lynx_parse_file()的flags
+enum {
+	LYNX_FILE_NO_MMAP = 1,	//不使用内存映射，先把整个文件读入缓冲区
+};
+
+//解析文件中的JSON文本：普通文件映射到内存后直接解析，不需要'\0'结尾，也不会先复制一份
+//文件无法打开或读取时返回LYNX_PARSE_FILE_ERROR
+int lynx_parse_file(lynx_value* v, const char* path, int flags);
+
+//lynx_parse_lines()的flags
+enum {
+	LYNX_LINES_UNORDERED = 1,	//按解析完成的顺序交付，不保证与输入的顺序一致
+};
+
+//lynx_parse_lines()的回调，每个非空行解析完成后调用一次，line为行号（从1开始），ret为这一行的解析结果
+//成功时v是解析出的节点，归回调所有（用完需要lynx_free()，也可以把*v整个复制出去）；失败时v为空节点。返回非0会中止整个批次
+typedef int (*lynx_line_handler)(void* ctx, size_t line, int ret, lynx_value* v);
+//多线程解析JSON Lines（NDJSON）：[buf, buf + len)中每行一个JSON文本，只含空白的行被跳过，某一行出错不影响其他行
+//nthreads为参与解析的线程数（包括调用线程），0表示CPU的核数；回调总是在调用线程中依次调用，默认按输入的顺序
+//全部交付后返回LYNX_PARSE_OK，回调中止时返回LYNX_PARSE_TERMINATED
+int lynx_parse_lines(const char* buf, size_t len, size_t nthreads, int flags, lynx_line_handler fn, void* ctx);
+
+//多线程解析根节点为数组的大文档：每个线程解析一段元素，最后按顺序拼接成一个数组，得到的节点和错误码与lynx_parse_n_ex()相同
+//nthreads为参与解析的线程数（包括调用线程），0表示CPU的核数；根节点不是数组、输入太小或者指定了opt->keys时按顺序解析
+//opt可以为NULL，opt->allocator会被多个线程同时使用
+int lynx_parse_parallel(lynx_value* v, const char* json, size_t len, size_t nthreads, const lynx_parse_options* opt);
+
+//SAX接口的回调，任何一个都可以为NULL（忽略对应的事件），返回非0会立即中止解析
+//字符串和键没有'\0'结尾，指向输入或者解析栈，只在回调期间有效
+typedef struct lynx_handler {
+	int (*null_value)(void* ctx);
+	int (*boolean)(void* ctx, int b);
+	int (*number)(void* ctx, double n);
+	int (*int64)(void* ctx, int64_t i);		//为NULL时整数交给number回调
+	int (*uint64)(void* ctx, uint64_t u);	//大于INT64_MAX的整数，为NULL时交给number回调
+	int (*string)(void* ctx, const char* s, size_t len);
+	int (*key)(void* ctx, const char* s, size_t len);
+	int (*start_object)(void* ctx);
+	int (*end_object)(void* ctx, size_t size);	//size为成员个数
+	int (*start_array)(void* ctx);
+	int (*end_array)(void* ctx, size_t size);	//size为元素个数
+} lynx_handler;
+
+//SAX解析：不创建节点，按顺序把解析到的每个值交给h中的回调，ctx会原样传给回调
+//出错时已经触发的回调不会撤销；回调中止解析时返回LYNX_PARSE_TERMINATED
+int lynx_parse_sax(const char* json, const lynx_handler* h, void* ctx);
+
+//增量解析器：JSON文本可以分成任意多段依次送入，在任意位置切分都可以，得到的节点和错误码与lynx_parse()相同
+typedef struct lynx_push_parser lynx_push_parser;
+lynx_push_parser* lynx_push_parser_create(void);
+//解析器本身和它的缓冲区使用opt中的分配器，opt可以为NULL
+lynx_push_parser* lynx_push_parser_create_ex(const lynx_parse_options* opt);
+void lynx_push_parser_destroy(lynx_push_parser* p);
+//送入一段输入，目前为止没有错误时返回LYNX_PARSE_OK；一旦出错就返回错误码，之后送入的内容都会被忽略
+int lynx_push_parser_feed(lynx_push_parser* p, const char* buf, size_t len);
+//输入结束，返回最终的结果，成功时解析出的节点存入v；之后解析器可以用于下一个文档
+int lynx_push_parser_finish(lynx_push_parser* p, lynx_value* v);
+
+//按需访问：只检查文档的结构，读取到的值才解析，没有访问的部分（包括其中的字符串和数字）不会被解码
+//lynx_lazy只是指向输入中的一个值，输入在使用期间必须一直有效
+typedef struct lynx_lazy {
+	const char* json;	//值的第一个字符
+	const char* end;	//输入的结尾
+} lynx_lazy;
+//检查[json, json + len)的括号和引号是否匹配，成功时root指向根节点；其余的错误在读取到相应的值时才报告
+int lynx_lazy_parse(lynx_lazy* root, const char* json, size_t len);
+lynx_type lynx_lazy_get_type(const lynx_lazy* v);
+//在对象中查找键/在数组中按下标查找，成功时out指向找到的值，没有时返回LYNX_PARSE_NOT_FOUND
+int lynx_lazy_find(const lynx_lazy* v, const char* key, size_t klen, lynx_lazy* out);
+int lynx_lazy_get_element(const lynx_lazy* v, size_t index, lynx_lazy* out);
+//读取值，语义同lynx_get_boolean()/lynx_get_number()/lynx_get_int64()
+int lynx_lazy_get_boolean(const lynx_lazy* v, int* b);
+int lynx_lazy_get_number(const lynx_lazy* v, double* n);
+int lynx_lazy_get_int64(const lynx_lazy* v, int64_t* i);
+//读取字符串，结果不以'\0'结尾，按*len使用：不含转义时*str直接指向输入，否则解码到buf（容量cap）中，*str指向buf
+//buf放不下时返回LYNX_PARSE_BUFFER_TOO_SMALL，*len仍是解码后的长度；不含转义的字符串不会用到buf，buf可以为NULL
+int lynx_lazy_get_string(const lynx_lazy* v, char* buf, size_t cap, const char** str, size_t* len);
+//把v指向的值（如字符串、子对象）完整地解析为节点，需要使用者调用lynx_free()释放
+int lynx_lazy_get_value(const lynx_lazy* v, lynx_value* out);
+
+//两阶段解析：先用SIMD找出所有结构字符的位置，再据此把整个文档写入一个连续的tape
+//tape中的节点用位置（size_t）表示，根节点是LYNX_TAPE_ROOT；tape可以重复用于解析多个文档，内存会被复用
+typedef struct lynx_tape lynx_tape;
+#define LYNX_TAPE_ROOT ((size_t)0)
+lynx_tape* lynx_tape_create(void);
+void lynx_tape_destroy(lynx_tape* t);
+//解析[json, json + len)，错误码同lynx_parse()；出错时根节点是null
+int lynx_tape_parse(lynx_tape* t, const char* json, size_t len);
+lynx_type lynx_tape_get_type(const lynx_tape* t, size_t i);
+//同一个数组/对象中的下一个节点（对象中键和值都是节点），跳过子节点只需要一步
+size_t lynx_tape_next(const lynx_tape* t, size_t i);
+//数组/对象的第一个子节点是i + 1，lynx_tape_end()是子节点之后的位置
+size_t lynx_tape_end(const lynx_tape* t, size_t i);
+int lynx_tape_get_boolean(const lynx_tape* t, size_t i);
+double lynx_tape_get_number(const lynx_tape* t, size_t i);
+int lynx_tape_is_int64(const lynx_tape* t, size_t i);
+int64_t lynx_tape_get_int64(const lynx_tape* t, size_t i);
+uint64_t lynx_tape_get_uint64(const lynx_tape* t, size_t i);
+//字符串以'\0'结尾，在下一次解析或销毁之前有效
+const char* lynx_tape_get_string(const lynx_tape* t, size_t i);
+size_t lynx_tape_get_string_length(const lynx_tape* t, size_t i);
+size_t lynx_tape_get_array_size(const lynx_tape* t, size_t i);
+size_t lynx_tape_get_array_element(const lynx_tape* t, size_t i, size_t index);
+size_t lynx_tape_get_object_size(const lynx_tape* t, size_t i);
+//返回键对应的值，不存在时返回LYNX_KEY_NOT_EXIST；对象的键就是值之前的节点
+size_t lynx_tape_find_object_value(const lynx_tape* t, size_t i, const char* key, size_t klen);
+//把节点i转换为lynx_value，需要使用者调用lynx_free()释放
+void lynx_tape_to_value(const lynx_tape* t, size_t i, lynx_value* v);
+
+//创建/销毁文档
+lynx_document* lynx_document_create(void);
+//文档本身、arena、解析栈以及修改文档中的数组/对象时申请的内存都使用分配器a（NULL表示全局分配器）
+lynx_document* lynx_document_create_ex(const lynx_allocator* a);
+//只释放arena和文档记录的内存块，不遍历节点
+//注意：通过lynx_set_string()、lynx_set_array()、lynx_set_object()、lynx_copy()、lynx_move()等赋给文档中节点的新值的存储空间属于节点自己，
+//销毁（或重新解析）文档之前要对这些节点调用lynx_free()，或者对根节点调用lynx_free()遍历释放；在文档的数组/对象中增删元素/成员不受影响
+void lynx_document_destroy(lynx_document* doc);
+//解析JSON文本到文档中，之前的内容会被释放（arena的内存会被复用）
+int lynx_document_parse(lynx_document* doc, const char* json);
+//同lynx_parse_insitu()，字符串引用json缓冲区，数组和对象从arena中分配
+int lynx_document_parse_insitu(lynx_document* doc, char* json);
+//文档的根节点，可以使用所有的lynx_*接口访问和修改
+//注意：从文档中移动（lynx_move/lynx_swap）出去的节点仍然引用文档的内存，不能在文档销毁之后使用
+lynx_value* lynx_document_root(lynx_document* doc);
+//之后的解析中对象的键（短键除外）引用键表t中的副本，NULL表示不使用；键表可以被多个文档共享，必须在使用它的文档之后销毁
+void lynx_document_set_key_table(lynx_document* doc, lynx_key_table* t);
+
+//键表：数组中的大量记录往往有相同的键，通过键表解析时相同的键只保存一份只读的副本，并预先计算好哈希
+//同一个键表可以用于多次解析（见lynx_parse_options::keys和lynx_document_set_key_table()），引用它的节点都释放之后才能销毁
+//键表中的键一直保留到键表销毁；键表不是线程安全的，同时进行的解析不能共享键表
+lynx_key_table* lynx_key_table_create(void);
+void lynx_key_table_destroy(lynx_key_table* t);
+//不同的键的个数
+size_t lynx_key_table_size(const lynx_key_table* t);
+//返回键在键表中的副本，没有时返回NULL；用副本查找对象（lynx_find_object_value()等）时只需比较指针
+const char* lynx_key_table_find(const lynx_key_table* t, const char* key, size_t klen);
 
 //释放节点申请的资源（字符串，数组，对象），在更改节点的类型或销毁节点时必须调用，否则会造成内存泄漏
 void lynx_free(lynx_value* v);
@@ -69,6 +286,8 @@ void lynx_free(lynx_value* v);
 lynx_type lynx_get_type(const lynx_value* v);
 
 //比较两个节点内容是否一致
+//数字按精确值比较，NaN与任何值（包括自身）都不相等；
+//但同一个数组/对象（或共享同一份存储的两个节点）直接视为相等，不逐个比较元素，其中的NaN也不例外
 int lynx_is_equal(const lynx_value* lhs, const lynx_value* rhs);
 
 //深拷贝
@@ -88,12 +307,23 @@ int lynx_get_boolean(const lynx_value* v);
 //将节点的类型设置为布尔，同时提供值
 void lynx_set_boolean(lynx_value* v, int b);
 
-//获取节点的实数值
+//获取节点的实数值，以整数存储的数值会被转换为double（可能损失精度）
 double lynx_get_number(const lynx_value* v);
 //将节点的类型设置为LYNX_NUMBER，同时提供值
 void lynx_set_number(lynx_value* v, double n);
 
-//获取节点的字符串值
+//没有小数和指数部分、且在int64_t/uint64_t范围内的数字，解析后以整数存储，不经过浮点运算也不会损失精度
+//数值是否以整数存储，并且能够用int64_t/uint64_t精确表示
+int lynx_is_int64(const lynx_value* v);
+int lynx_is_uint64(const lynx_value* v);
+//获取节点的整数值，以double存储的数值会被截断取整（必须在目标类型的范围内）
+int64_t lynx_get_int64(const lynx_value* v);
+uint64_t lynx_get_uint64(const lynx_value* v);
+//将节点的类型设置为LYNX_NUMBER，并以整数存储值
+void lynx_set_int64(lynx_value* v, int64_t i);
+void lynx_set_uint64(lynx_value* v, uint64_t u);
+
+//获取节点的字符串值，短字符串的内容在节点中，节点被移动（如所在的数组扩容）之后要重新获取
 const char* lynx_get_string(const lynx_value* v);
 //获取节点字符串长度
 size_t lynx_get_string_length(const lynx_value* v);
@@ -130,8 +360,37 @@ lynx_value* lynx_find_object_value(const lynx_value* v, const char* key, size_t
 void lynx_remove_object_value(lynx_value* v, size_t index);
 lynx_value* lynx_set_object_value(lynx_value* v, const char* key, size_t klen);
 void lynx_clear_object(lynx_value* v);
+//为对象建立哈希索引，之后按键查找和插入都是O(1)，成员的顺序不变
+//成员数达到LYNX_OBJECT_INDEX_THRESHOLD（默认16）的对象在解析、插入和复制时会自动建立索引，索引由各个lynx_*接口负责维护
+void lynx_build_object_index(lynx_value* v);
 
-//将节点转为json文本，需要使用者自行free字符串
+//编译好的JSON Pointer（RFC 6901），如"/user/profile/id"、"/items/0"，""表示整个文档
+//同一个路径需要反复查找时先编译一次，之后每次求值不再解析路径，查找带索引的对象时也不再计算键的哈希值
+typedef struct lynx_path lynx_path;
+//路径不合法（不以'/'开头，或者'~'之后不是'0'/'1'）时返回NULL
+lynx_path* lynx_path_compile(const char* pointer);
+void lynx_path_free(lynx_path* p);
+//返回路径指向的节点，不存在时返回NULL
+lynx_value* lynx_path_eval(const lynx_path* p, const lynx_value* root);
+//一次求出n条路径，结果依次存入out；相邻两条路径的相同前缀只查找一次，所以按前缀排列的路径求值更快
+void lynx_path_eval_batch(const lynx_path* const* paths, size_t n, const lynx_value* root, lynx_value** out);
+
+//将节点转为json文本，需要使用者自行释放字符串（使用全局分配器的free）
 int lynx_stringify(const lynx_value* v, char** json, size_t* length);
+//同lynx_stringify()，输出的字符串由分配器a申请（NULL表示全局分配器），使用者应使用a释放
+int lynx_stringify_ex(const lynx_value* v, char** json, size_t* length, const lynx_allocator* a);
+
+//输出函数：写出[buf, buf + len)，成功返回0，返回非0时lynx_stringify_to()不再输出并返回LYNX_STRINGIFY_WRITE_ERROR
+typedef int (*lynx_write_fn)(void* ctx, const char* buf, size_t len);
+//流式输出：json文本经过固定大小的缓冲区（LYNX_STRINGIFY_BUFFER_SIZE）分段交给write，不会一次生成整个字符串
+int lynx_stringify_to(const lynx_value* v, lynx_write_fn write, void* ctx);
+//同lynx_stringify_to()，输出到文件描述符fd（如套接字、管道、文件）
+int lynx_stringify_fd(const lynx_value* v, int fd);
+
+//lynx_stringify()输出的json文本的长度（不含'\0'），只计算不生成文本
+size_t lynx_stringify_size(const lynx_value* v);
+//输出到调用者提供的缓冲区[buf, buf + cap)，不申请也不扩容任何内存；缓冲区还有空间时在文本之后写入'\0'
+//length（可以为NULL）返回文本的长度，放不下时返回LYNX_STRINGIFY_BUFFER_TOO_SMALL，length仍是需要的长度
+int lynx_stringify_into(const lynx_value* v, char* buf, size_t cap, size_t* length);
 
 #endif
\ No newline at end of file
@@ -1,3 +1,8 @@
+//fileno()在严格的C99模式下需要显式声明
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +34,9 @@ static int test_pass = 0;
 #define EXPECT_EQ_SIZE_T(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (size_t)expect, (size_t)actual, "%I64u")
 #endif
 
+#define EXPECT_EQ_INT64(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (long long)(expect), (long long)(actual), "%lld")
+#define EXPECT_EQ_UINT64(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (unsigned long long)(expect), (unsigned long long)(actual), "%llu")
+
 #define EXPECT_TRUE(actual) EXPECT_EQ_BASE(actual, "true", "false", "%s")
 #define EXPECT_FALSE(actual) EXPECT_EQ_BASE(!actual, "false", "true", "%s")
 #define TEST_ERROR(error, json)\
@@ -39,6 +47,14 @@ static int test_pass = 0;
 		EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));\
 	} while(0)
 
+#define TEST_ERROR_INSITU(error, json)\
+	do {\
+		lynx_value v;\
+		v.type = LYNX_FALSE;\
+		EXPECT_EQ_INT(error, lynx_parse_insitu(&v, json));\
+		EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));\
+	} while(0)
+
 #define TEST_NUMBER(expect, json)\
 	do {\
 		lynx_value v;\
@@ -47,6 +63,23 @@ static int test_pass = 0;
 		EXPECT_EQ_DOUBLE(expect, lynx_get_number(&v));\
 	} while(0)
 
+#define TEST_INT64(expect, json)\
+	do {\
+		lynx_value v;\
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));\
+		EXPECT_EQ_INT(LYNX_NUMBER, lynx_get_type(&v));\
+		EXPECT_TRUE(lynx_is_int64(&v));\
+		EXPECT_EQ_INT64(expect, lynx_get_int64(&v));\
+	} while(0)
+
+#define TEST_UINT64(expect, json)\
+	do {\
+		lynx_value v;\
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));\
+		EXPECT_EQ_INT(LYNX_NUMBER, lynx_get_type(&v));\
+		EXPECT_TRUE(lynx_is_uint64(&v));\
+		EXPECT_EQ_UINT64(expect, lynx_get_uint64(&v));\
+	} while(0)
 
 #define TEST_STRING(expect, json)\
 	do {\
@@ -55,6 +88,7 @@ static int test_pass = 0;
 		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));\
 		EXPECT_EQ_INT(LYNX_STRING, lynx_get_type(&v));\
 		EXPECT_EQ_STRING(expect, lynx_get_string(&v), lynx_get_string_length(&v));\
+		lynx_free(&v);\
 	} while (0)
 
 #define TEST_ROUNDTRIP(json)\
@@ -84,14 +118,24 @@ static void test_stringify()
     TEST_ROUNDTRIP("-1.5");
     TEST_ROUNDTRIP("3.25");
 #if 1
-    TEST_ROUNDTRIP("1e+020");
-    TEST_ROUNDTRIP("1.234e+020");
-    TEST_ROUNDTRIP("1.234e-020");
+    TEST_ROUNDTRIP("1e+20");
+    TEST_ROUNDTRIP("1.234e+20");
+    TEST_ROUNDTRIP("1.234e-20");
     TEST_ROUNDTRIP("1.0000000000000002");
-    TEST_ROUNDTRIP("4.9406564584124654e-324"); /* minimum denormal */
-    TEST_ROUNDTRIP("-4.9406564584124654e-324");
-    TEST_ROUNDTRIP("2.2250738585072009e-308");  /* Max subnormal double */
-    TEST_ROUNDTRIP("-2.2250738585072009e-308");
+    TEST_ROUNDTRIP("9007199254740993");
+    TEST_ROUNDTRIP("-9223372036854775808");
+    TEST_ROUNDTRIP("18446744073709551615");
+    TEST_ROUNDTRIP("0.1");
+    TEST_ROUNDTRIP("0.30000000000000004");
+    TEST_ROUNDTRIP("0.0001");
+    TEST_ROUNDTRIP("1e-05");
+    TEST_ROUNDTRIP("9007199254740991");
+    TEST_ROUNDTRIP("10000000000000000");
+    TEST_ROUNDTRIP("1e+17");
+    TEST_ROUNDTRIP("5e-324"); /* minimum denormal */
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");  /* Max subnormal double */
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
     TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
     TEST_ROUNDTRIP("-2.2250738585072014e-308");
     TEST_ROUNDTRIP("1.7976931348623157e+308");  /* Max double */
@@ -103,6 +147,8 @@ static void test_stringify()
     TEST_ROUNDTRIP("\"Hello\\nWorld\"");
     TEST_ROUNDTRIP("\"\\\" \\\\ / \\b \\f \\n \\r \\t\"");
     TEST_ROUNDTRIP("\"Hello\\u0000World\"");
+    TEST_ROUNDTRIP("\"\\u0001\\u001F\xE4\xBD\xA0\"");
+    TEST_ROUNDTRIP("\"0123456789abcdef0123456789abcdef\\\"0123456789abcdef0123456789abcdef\\n\"");
 
     TEST_ROUNDTRIP("[]");
     TEST_ROUNDTRIP("[null,false,true,123,\"abc\",[1,2,3]]");
@@ -111,6 +157,156 @@ static void test_stringify()
     TEST_ROUNDTRIP("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
 }
 
+//把lynx_stringify_to()的输出收集起来，fail_after次之后返回错误
+typedef struct {
+	char* buf;
+	size_t len, calls, fail_after;
+} test_writer;
+
+static int test_write(void* ctx, const char* buf, size_t len)
+{
+	test_writer* w = (test_writer*)ctx;
+	if (w->calls++ == w->fail_after) return -1;
+	w->buf = (char*)realloc(w->buf, w->len + len);
+	memcpy(w->buf + w->len, buf, len);
+	w->len += len;
+	return 0;
+}
+
+static void test_stringify_to()
+{
+	static const char* const path = "lynx_test_stringify.json";
+	test_writer w = { NULL, 0, 0, (size_t)-1 };
+	lynx_value v, v2;
+	char* json;
+	size_t len, i;
+	FILE* fp;
+
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "{\"a\":[1,2.5,true],\"s\":\"x\\ny\"}"));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_to(&v, test_write, &w));
+	EXPECT_EQ_STRING("{\"a\":[1,2.5,true],\"s\":\"x\\ny\"}", w.buf, w.len);
+	EXPECT_EQ_SIZE_T(1, w.calls);
+	lynx_free(&v);
+
+	//输出超过缓冲区时分多次写出，拼起来与lynx_stringify()相同
+	lynx_set_array(&v, 0);
+	for (i = 0; i < 10000; i++) {
+		lynx_value* e = lynx_pushback_array_element(&v);
+		if (i % 2) lynx_set_number(e, i * 0.25);
+		else lynx_set_string(e, "Hello\tWorld", 11);
+	}
+	free(w.buf);
+	w.buf = NULL; w.len = w.calls = 0;
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_to(&v, test_write, &w));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&v, &json, &len));
+	EXPECT_TRUE(w.calls > 1);
+	EXPECT_TRUE(w.len == len && memcmp(w.buf, json, len) == 0);
+	free(json);
+
+	//比缓冲区还长的字符串
+	lynx_free(&v);
+	lynx_set_array(&v, 0);
+	json = (char*)malloc(100000);
+	memset(json, 'a', 100000);
+	json[50000] = '\n';
+	lynx_set_string(lynx_pushback_array_element(&v), json, 100000);
+	lynx_set_string(lynx_pushback_array_element(&v), json, 10);
+	free(json);
+	free(w.buf);
+	w.buf = NULL; w.len = w.calls = 0;
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_to(&v, test_write, &w));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&v, &json, &len));
+	EXPECT_EQ_SIZE_T(100000 + 1 + 14 + 3, len);
+	EXPECT_TRUE(w.len == len && memcmp(w.buf, json, len) == 0);
+	free(json);
+
+	//输出函数出错后不再调用
+	free(w.buf);
+	w.buf = NULL; w.len = w.calls = 0; w.fail_after = 1;
+	EXPECT_EQ_INT(LYNX_STRINGIFY_WRITE_ERROR, lynx_stringify_to(&v, test_write, &w));
+	EXPECT_EQ_SIZE_T(2, w.calls);
+	free(w.buf);
+
+	fp = fopen(path, "wb");
+	EXPECT_TRUE(fp != NULL);
+	if (fp) {
+		EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_fd(&v, fileno(fp)));
+		fclose(fp);
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_file(&v2, path, 0));
+		EXPECT_TRUE(lynx_is_equal(&v, &v2));
+		lynx_free(&v2);
+		remove(path);
+	}
+	lynx_free(&v);
+}
+
+//lynx_stringify_size()与lynx_stringify()的长度相同，lynx_stringify_into()的输出与lynx_stringify()相同
+#define TEST_STRINGIFY_SIZE(json)\
+	do {\
+		lynx_value v;\
+		char* json2;\
+		char buf[256];\
+		size_t len, len2;\
+		lynx_init(&v);\
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));\
+		EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&v, &json2, &len));\
+		EXPECT_EQ_SIZE_T(len, lynx_stringify_size(&v));\
+		EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_into(&v, buf, len, &len2));\
+		EXPECT_TRUE(len2 == len && memcmp(json2, buf, len) == 0);\
+		EXPECT_EQ_INT(LYNX_STRINGIFY_BUFFER_TOO_SMALL, lynx_stringify_into(&v, buf, len - 1, &len2));\
+		EXPECT_EQ_SIZE_T(len, len2);\
+		lynx_free(&v);\
+		free(json2);\
+	} while (0)
+
+static void test_stringify_into()
+{
+	lynx_value v;
+	char buf[8], big[256], *json;
+	size_t len, len2, i;
+
+	TEST_STRINGIFY_SIZE("null");
+	TEST_STRINGIFY_SIZE("false");
+	TEST_STRINGIFY_SIZE("-9223372036854775808");
+	TEST_STRINGIFY_SIZE("18446744073709551615");
+	TEST_STRINGIFY_SIZE("-1.234e-20");
+	TEST_STRINGIFY_SIZE("0.30000000000000004");
+	TEST_STRINGIFY_SIZE("\"\"");
+	TEST_STRINGIFY_SIZE("\"\\\" \\\\ / \\b \\f \\n \\r \\t \\u0001 \\u001F \xE4\xBD\xA0\"");
+	TEST_STRINGIFY_SIZE("[]");
+	TEST_STRINGIFY_SIZE("[null,false,true,123,\"abc\",[1,2,3]]");
+	TEST_STRINGIFY_SIZE("{}");
+	TEST_STRINGIFY_SIZE("{\"n\":null,\"a\\tb\":[1,2.5,[]],\"o\":{\"1\":{}}}");
+	TEST_STRINGIFY_SIZE("[0.1,0.2,0.30000000000000004,1e+300,-1.234e-20,123456789,-9223372036854775808,18446744073709551615,2.5,3.75]");
+	TEST_STRINGIFY_SIZE("[\"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\",\"a\\nb\"]");
+
+	//直接写入调用者的缓冲区：任意容量下要么完整输出，要么报告所需长度
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "{\"numbers\":[0.1,0.2,0.30000000000000004,1e+300,123456789,-1.234e-20],"
+		"\"text\":\"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\",\"end\":true}"));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&v, &json, &len));
+	for (i = 0; i <= len + 1 && i <= sizeof(big); i++) {
+		EXPECT_EQ_INT(i < len ? LYNX_STRINGIFY_BUFFER_TOO_SMALL : LYNX_STRINGIFY_OK, lynx_stringify_into(&v, big, i, &len2));
+		EXPECT_EQ_SIZE_T(len, len2);
+		if (i >= len)
+			EXPECT_TRUE(memcmp(json, big, len) == 0);
+	}
+	free(json);
+	lynx_free(&v);
+
+	//缓冲区还有空间时写入'\0'
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "[1,2]"));
+	memset(buf, 'x', sizeof(buf));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_into(&v, buf, sizeof(buf), &len));
+	EXPECT_EQ_SIZE_T(5, len);
+	EXPECT_EQ_STRING("[1,2]", buf, strlen(buf));
+	EXPECT_EQ_INT(LYNX_STRINGIFY_BUFFER_TOO_SMALL, lynx_stringify_into(&v, NULL, 0, &len));
+	EXPECT_EQ_SIZE_T(5, len);
+	lynx_free(&v);
+}
+
 static void test_parse_null()
 {
 	lynx_value v;
@@ -165,6 +361,66 @@ static void test_parse_number()
 	TEST_NUMBER(-2.2250738585072009e-308, "-2.2250738585072009e-308");
 	TEST_NUMBER( 2.2250738585072014e-308, "2.2250738585072014e-308");
 	TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
+
+	//需要正确舍入的情况
+	TEST_NUMBER(1e23, "1e23");
+	TEST_NUMBER(9007199254740992.0, "9007199254740993.0");	//两个double的中点，向偶数舍入
+	TEST_NUMBER(9007199254740994.0, "9007199254740993.0000000000000000001");
+	TEST_NUMBER(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+	TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+	TEST_NUMBER(1.0, "1.00000000000000000000000000000000000000000000000001");
+	TEST_NUMBER(123456789012345678901234567890.0, "123456789012345678901234567890");
+	TEST_NUMBER(1.7976931348623157E308, "1.7976931348623158e308");
+}
+
+static void test_parse_int64()
+{
+	lynx_value v, w;
+	TEST_INT64(0, "0");
+	TEST_INT64(1, "1");
+	TEST_INT64(-1, "-1");
+	TEST_INT64(9007199254740993LL, "9007199254740993");	//2^53 + 1，double无法表示
+	TEST_INT64(INT64_MAX, "9223372036854775807");
+	TEST_INT64(INT64_MIN, "-9223372036854775808");
+	TEST_UINT64(123, "123");
+	TEST_UINT64(9223372036854775808ULL, "9223372036854775808");
+	TEST_UINT64(UINT64_MAX, "18446744073709551615");
+
+	//有小数、指数部分或超出范围的数字仍然是double
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "-0"));
+	EXPECT_FALSE(lynx_is_int64(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "1.0"));
+	EXPECT_FALSE(lynx_is_int64(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "1e2"));
+	EXPECT_FALSE(lynx_is_int64(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "-9223372036854775809"));
+	EXPECT_FALSE(lynx_is_int64(&v));
+	EXPECT_EQ_DOUBLE(-9223372036854775808.0, lynx_get_number(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "18446744073709551616"));
+	EXPECT_FALSE(lynx_is_uint64(&v));
+	EXPECT_EQ_DOUBLE(18446744073709551616.0, lynx_get_number(&v));
+
+	lynx_set_uint64(&v, 5);
+	EXPECT_TRUE(lynx_is_int64(&v));
+	EXPECT_EQ_INT64(5, lynx_get_int64(&v));
+	lynx_set_int64(&v, -5);
+	EXPECT_FALSE(lynx_is_uint64(&v));
+	EXPECT_EQ_DOUBLE(-5.0, lynx_get_number(&v));
+
+	//整数与double比较
+	lynx_init(&w);
+	lynx_set_number(&w, -5.0);
+	EXPECT_TRUE(lynx_is_equal(&v, &w));
+	lynx_set_int64(&v, 9007199254740993LL);
+	lynx_set_number(&w, 9007199254740992.0);
+	EXPECT_FALSE(lynx_is_equal(&v, &w));
+	EXPECT_FALSE(lynx_is_equal(&w, &v));
+	lynx_set_uint64(&v, UINT64_MAX);
+	lynx_set_number(&w, 18446744073709551616.0);
+	EXPECT_FALSE(lynx_is_equal(&v, &w));
+	lynx_free(&v);
+	lynx_free(&w);
 }
 
 static void test_parse_string()
@@ -179,6 +435,9 @@ static void test_parse_string()
 	TEST_STRING("\xE2\x82\xAC", "\"\\u20AC\"");
 	TEST_STRING("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");
 	TEST_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");
+	//跨越多个16/32字节块的长字符串
+	TEST_STRING("0123456789abcdef0123456789abcdef0123456789\n\xE4\xBD\xA0\xE5\xA5\xBD" "0123456789abcdef0123456789abcdef",
+		"\"0123456789abcdef0123456789abcdef0123456789\\n\xE4\xBD\xA0\xE5\xA5\xBD" "0123456789abcdef0123456789abcdef\"");
 }
 
 static void test_parse_array()
@@ -279,6 +538,398 @@ static void test_parse_object()
     lynx_free(&v);
 }
 
+static void test_parse_insitu()
+{
+	lynx_value v, *pv;
+	char json[] = "{\"name\": \"lynx\\tjson parsed in situ\", \"k\\u0065y\": [\"\\uD834\\uDD1E\", \"abc\"]}";
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_insitu(&v, json));
+	EXPECT_EQ_INT(LYNX_OBJECT, lynx_get_type(&v));
+	EXPECT_EQ_SIZE_T(2, lynx_get_object_size(&v));
+	EXPECT_EQ_STRING("name", lynx_get_object_key(&v, 0), lynx_get_object_key_length(&v, 0));
+	EXPECT_EQ_STRING("key", lynx_get_object_key(&v, 1), lynx_get_object_key_length(&v, 1));
+	pv = lynx_get_object_value(&v, 0);
+	EXPECT_EQ_STRING("lynx\tjson parsed in situ", lynx_get_string(pv), lynx_get_string_length(pv));
+	//字符串直接位于输入缓冲区中（短字符串除外，它们存放在节点中）
+	EXPECT_TRUE(lynx_get_string(pv) > json && lynx_get_string(pv) < json + sizeof(json));
+	pv = lynx_get_object_value(&v, 1);
+	EXPECT_EQ_STRING("\xF0\x9D\x84\x9E", lynx_get_string(lynx_get_array_element(pv, 0)), lynx_get_string_length(lynx_get_array_element(pv, 0)));
+	EXPECT_EQ_STRING("abc", lynx_get_string(lynx_get_array_element(pv, 1)), lynx_get_string_length(lynx_get_array_element(pv, 1)));
+
+	//修改原地解析的结果
+	lynx_set_string(lynx_get_array_element(pv, 1), "def", 3);
+	lynx_set_number(lynx_set_object_value(&v, "new", 3), 1.0);
+	lynx_remove_object_value(&v, 0);
+	EXPECT_EQ_SIZE_T(2, lynx_get_object_size(&v));
+	EXPECT_EQ_STRING("key", lynx_get_object_key(&v, 0), lynx_get_object_key_length(&v, 0));
+	EXPECT_EQ_STRING("new", lynx_get_object_key(&v, 1), lynx_get_object_key_length(&v, 1));
+	lynx_free(&v);
+
+	{
+		char bad[] = "[\"abc\", \"\\x\"]";
+		TEST_ERROR_INSITU(LYNX_PARSE_INVALID_STRING_ESCAPE, bad);
+	}
+	{
+		char bad[] = "{\"a\": 1, \"b\"}";
+		TEST_ERROR_INSITU(LYNX_PARSE_MISS_COLON, bad);
+	}
+}
+
+static void test_parse_document()
+{
+	lynx_document* doc = lynx_document_create();
+	lynx_value *root, *pv, v;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, "{\"a\": [1, \"two\", {\"x\": null}], \"s\": \"str\"}"));
+	root = lynx_document_root(doc);
+	EXPECT_EQ_INT(LYNX_OBJECT, lynx_get_type(root));
+	pv = lynx_find_object_value(root, "a", 1);
+	EXPECT_TRUE(pv != NULL);
+	EXPECT_EQ_SIZE_T(3, lynx_get_array_size(pv));
+	EXPECT_EQ_STRING("two", lynx_get_string(lynx_get_array_element(pv, 1)), lynx_get_string_length(lynx_get_array_element(pv, 1)));
+
+	//修改arena中的节点
+	lynx_set_string(lynx_pushback_array_element(pv), "four", 4);
+	EXPECT_EQ_SIZE_T(4, lynx_get_array_size(pv));
+	EXPECT_EQ_STRING("four", lynx_get_string(lynx_get_array_element(pv, 3)), lynx_get_string_length(lynx_get_array_element(pv, 3)));
+	lynx_set_string(lynx_get_array_element(pv, 1), "2", 1);
+	lynx_set_boolean(lynx_set_object_value(lynx_get_array_element(pv, 2), "y", 1), 1);
+	EXPECT_EQ_SIZE_T(2, lynx_get_object_size(lynx_get_array_element(pv, 2)));
+	lynx_remove_object_value(root, lynx_find_object_index(root, "s", 1));
+	lynx_set_number(lynx_set_object_value(root, "n", 1), 3.0);
+	EXPECT_EQ_SIZE_T(2, lynx_get_object_size(root));
+	EXPECT_EQ_DOUBLE(3.0, lynx_get_number(lynx_find_object_value(root, "n", 1)));
+
+	//深拷贝出来的节点与文档无关
+	lynx_init(&v);
+	lynx_copy(&v, pv);
+	EXPECT_TRUE(lynx_is_equal(&v, pv));
+
+	//重复解析到同一个文档
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lynx_document_parse(doc, "[\"abc\", {\"k\": 1} 2]"));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(lynx_document_root(doc)));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, "[\"abc\", {\"k\": 1}]"));
+	EXPECT_EQ_SIZE_T(2, lynx_get_array_size(lynx_document_root(doc)));
+	lynx_document_destroy(doc);
+
+	EXPECT_EQ_SIZE_T(4, lynx_get_array_size(&v));
+	EXPECT_EQ_STRING("four", lynx_get_string(lynx_get_array_element(&v, 3)), lynx_get_string_length(lynx_get_array_element(&v, 3)));
+	lynx_free(&v);
+}
+
+static void test_parse_key_table()
+{
+	static const char json[] = "[{\"a_rather_long_key_name\": 1, \"id\": 2}, {\"id\": 3, \"a_rather_long_key_name\": 4}]";
+	lynx_key_table* keys = lynx_key_table_create();
+	lynx_document* doc = lynx_document_create();
+	lynx_parse_options opt;
+	lynx_value v, w, c;
+	const char *k0, *k1, *key;
+	char buf[1024], *p;
+	size_t i;
+
+	memset(&opt, 0, sizeof(opt));
+	opt.keys = keys;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&v, json, &opt));
+	//相同的长键是同一份副本，短键不进入键表
+	EXPECT_EQ_SIZE_T(1, lynx_key_table_size(keys));
+	k0 = lynx_get_object_key(lynx_get_array_element(&v, 0), 0);
+	k1 = lynx_get_object_key(lynx_get_array_element(&v, 1), 1);
+	EXPECT_TRUE(k0 == k1);
+	key = lynx_key_table_find(keys, "a_rather_long_key_name", 22);
+	EXPECT_TRUE(key == k0);
+	EXPECT_TRUE(lynx_key_table_find(keys, "id", 2) == NULL);
+	EXPECT_EQ_DOUBLE(4.0, lynx_get_number(lynx_find_object_value(lynx_get_array_element(&v, 1), key, 22)));
+	EXPECT_EQ_DOUBLE(1.0, lynx_get_number(lynx_find_object_value(lynx_get_array_element(&v, 0), "a_rather_long_key_name", 22)));
+
+	//多次解析共享键表，包括文档和增量解析器
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&w, json, &opt));
+	EXPECT_TRUE(lynx_is_equal(&v, &w));
+	EXPECT_TRUE(lynx_get_object_key(lynx_get_array_element(&w, 0), 0) == key);
+	lynx_document_set_key_table(doc, keys);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, "{\"another_long_key_name\": {\"a_rather_long_key_name\": null}}"));
+	EXPECT_EQ_SIZE_T(2, lynx_key_table_size(keys));
+	EXPECT_TRUE(lynx_get_object_key(lynx_get_object_value(lynx_document_root(doc), 0), 0) == key);
+
+	//成员足够多时建立索引，使用键表中记录的哈希
+	lynx_init(&c);
+	lynx_copy(&c, &v);
+	lynx_free(&w);
+	p = buf;
+	for (i = 0; i < 32; i++)
+		p += sprintf(p, "%c\"k%02d_some_padding_here\": %d", i ? ',' : '{', (int)i, (int)i);
+	strcpy(p, "}");
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&w, buf, &opt));
+	EXPECT_EQ_SIZE_T(34, lynx_key_table_size(keys));
+	key = lynx_key_table_find(keys, "k07_some_padding_here", 21);
+	EXPECT_TRUE(key != NULL);
+	EXPECT_EQ_SIZE_T(7, lynx_find_object_index(&w, key, 21));
+	EXPECT_EQ_SIZE_T(31, lynx_find_object_index(&w, "k31_some_padding_here", 21));
+	lynx_free(&w);
+
+	lynx_document_destroy(doc);
+	lynx_free(&v);
+	lynx_key_table_destroy(keys);
+	//深拷贝的节点不引用键表
+	EXPECT_EQ_DOUBLE(4.0, lynx_get_number(lynx_find_object_value(lynx_get_array_element(&c, 1), "a_rather_long_key_name", 22)));
+	lynx_free(&c);
+}
+
+//n层嵌套的数组，最内层是一个数字
+static char* test_nested_array(size_t n)
+{
+	char* json = (char*)malloc(2 * n + 2);
+	memset(json, '[', n);
+	json[n] = '0';
+	memset(json + n + 1, ']', n);
+	json[2 * n + 1] = '\0';
+	return json;
+}
+
+typedef struct {
+	size_t count;		//收到的行数
+	size_t last;		//上一次收到的行号
+	size_t errors;
+	size_t bad;			//不符合预期的行数，逐行使用EXPECT会让测试数量随输入变化
+	int ordered;		//行号必须递增
+	size_t stop_after;	//收到这么多行之后中止，0表示不中止
+	unsigned char* seen;
+} lines_result;
+
+//第i行是{"line":i,...}，每97行有一行缺少逗号
+static int lines_handler(void* ctx, size_t line, int ret, lynx_value* v)
+{
+	lines_result* r = (lines_result*)ctx;
+	if (r->ordered && line <= r->last) r->bad++;
+	r->last = line;
+	if (r->seen) {
+		if (r->seen[line]) r->bad++;
+		r->seen[line] = 1;
+	}
+	if (ret == LYNX_PARSE_OK) {
+		if (lynx_get_number(lynx_find_object_value(v, "line", 4)) != (double)line) r->bad++;
+		lynx_free(v);
+	}
+	else {
+		if (ret != LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET || lynx_get_type(v) != LYNX_NULL || line % 97 != 0) r->bad++;
+		r->errors++;
+	}
+	return ++r->count == r->stop_after;
+}
+
+//记录每一行的解析结果，-1表示没有交付
+static int lines_small_handler(void* ctx, size_t line, int ret, lynx_value* v)
+{
+	int* rets = (int*)ctx;
+	EXPECT_EQ_INT(-1, rets[line]);
+	rets[line] = ret;
+	lynx_free(v);
+	return 0;
+}
+
+static void test_parse_lines()
+{
+	static const char small[] = "1\n\n  \n[2]\r\nx\n\"a\"";
+	int rets[8], ret;
+	lynx_value v;
+	lines_result r;
+	char *buf, *p;
+	size_t i, n = 40000, len, threads;
+
+	//空行和只含空白的行被跳过，最后一行可以没有'\n'
+	memset(rets, -1, sizeof(rets));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_lines(small, sizeof(small) - 1, 1, 0, lines_small_handler, rets));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, rets[1]);
+	EXPECT_EQ_INT(-1, rets[2]);
+	EXPECT_EQ_INT(-1, rets[3]);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, rets[4]);
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, rets[5]);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, rets[6]);
+	EXPECT_EQ_INT(-1, rets[7]);
+
+	//每行的错误码与单独解析这一行相同，与后面是否还有行无关
+	lynx_init(&v);
+	ret = lynx_parse(&v, "\"abc");
+	memset(rets, -1, sizeof(rets));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_lines("\"abc\n1\n\"abc", 11, 1, 0, lines_small_handler, rets));
+	EXPECT_EQ_INT(ret, rets[1]);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, rets[2]);
+	EXPECT_EQ_INT(ret, rets[3]);
+	memset(&r, 0, sizeof(r));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_lines("", 0, 0, 0, lines_handler, &r));
+	EXPECT_EQ_SIZE_T(0, r.count);
+
+	//输入足够大，分成多块由多个线程解析
+	buf = p = (char*)malloc(n * 80);
+	for (i = 1; i <= n; i++) {
+		if (i % 97 == 0)
+			p += sprintf(p, "{\"line\":%d \"broken\":true}\n", (int)i);
+		else
+			p += sprintf(p, "{\"line\":%d,\"name\":\"record number %d\",\"tags\":[1,2,3]}\n", (int)i, (int)i);
+	}
+	len = p - buf;
+	for (threads = 1; threads <= 4; threads *= 2) {
+		memset(&r, 0, sizeof(r));
+		r.ordered = 1;
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_lines(buf, len, threads, 0, lines_handler, &r));
+		EXPECT_EQ_SIZE_T(n, r.count);
+		EXPECT_EQ_SIZE_T(n / 97, r.errors);
+		EXPECT_EQ_SIZE_T(n, r.last);
+		EXPECT_EQ_SIZE_T(0, r.bad);
+	}
+
+	//不保证顺序时每一行仍然恰好交付一次，行号不变
+	memset(&r, 0, sizeof(r));
+	r.seen = (unsigned char*)calloc(n + 1, 1);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_lines(buf, len, 4, LYNX_LINES_UNORDERED, lines_handler, &r));
+	EXPECT_EQ_SIZE_T(n, r.count);
+	EXPECT_EQ_SIZE_T(n / 97, r.errors);
+	EXPECT_EQ_SIZE_T(0, r.bad);
+	free(r.seen);
+
+	//回调中止后不再交付，其余已经解析的节点由解析器释放
+	memset(&r, 0, sizeof(r));
+	r.ordered = 1;
+	r.stop_after = 1000;
+	EXPECT_EQ_INT(LYNX_PARSE_TERMINATED, lynx_parse_lines(buf, len, 4, 0, lines_handler, &r));
+	EXPECT_EQ_SIZE_T(1000, r.count);
+	EXPECT_EQ_SIZE_T(1000, r.last);
+	EXPECT_EQ_SIZE_T(0, r.bad);
+	free(buf);
+}
+
+//并行与顺序解析的结果（包括错误码）必须相同
+static void expect_parse_parallel(const char* json, size_t len, size_t threads, const lynx_parse_options* opt)
+{
+	lynx_value v, w;
+	int ret = lynx_parse_n_ex(&v, json, len, opt);
+	EXPECT_EQ_INT(ret, lynx_parse_parallel(&w, json, len, threads, opt));
+	EXPECT_TRUE(lynx_is_equal(&v, &w));
+	lynx_free(&v);
+	lynx_free(&w);
+}
+
+static void test_parse_parallel()
+{
+	//元素中的字符串含有各种括号、逗号、引号和连续的反斜杠，段的边界可能落在任何位置
+	static const char* elements[] = {
+		"{\"id\":%d,\"s\":\"a,b]c}\\\"d\\\\\",\"t\":[1,[2,{\"u\":\"],[\"}]]}",
+		"\"%d\\\\\\\\\\\"],\"",
+		"[%d, \"\\\\\", {}, [], \"[{\"]",
+		"%d.5e-3",
+		"{\"k\" : { \"nested\" : [ \"\\u0041\", null, true, false, \"\\\\\\\"\" ] }, \"n\": %d}",
+	};
+	size_t n = 120000, i, len, threads;
+	char *buf = (char*)malloc(n * 80 + (3 << 20)), *p = buf, *q;
+	lynx_parse_options opt;
+	lynx_value v;
+
+	p += sprintf(p, " \r\n[");
+	for (i = 0; i < n; i++) {
+		if (i) p += sprintf(p, i % 7 ? "," : " ,\n ");
+		p += sprintf(p, elements[i % 5], (int)i);
+	}
+	p += sprintf(p, "]\n");
+	len = p - buf;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_parallel(&v, buf, len, 4, NULL));
+	EXPECT_EQ_SIZE_T(n, lynx_get_array_size(&v));
+	lynx_free(&v);
+	for (threads = 2; threads <= 7; threads++)
+		expect_parse_parallel(buf, len, threads, NULL);
+
+	//跨越好几段的元素
+	p = buf + len - 2;
+	p += sprintf(p, ",\"");
+	for (i = 0; i < (3 << 20) - 64; i++)
+		*p++ = "],[\\\"}{x"[i % 8] == '\\' ? 'x' : "],[{}x,\"a"[i % 9] == '\"' ? 'y' : "],[{}x,\"a"[i % 9];
+	p += sprintf(p, "\", 1]");
+	expect_parse_parallel(buf, p - buf, 4, NULL);
+	memcpy(buf + len - 2, "]\n", 2);
+
+	//各种错误：与顺序解析的错误码相同，而且节点为空
+	expect_parse_parallel(buf, len - 2, 4, NULL);	//缺少']'
+	q = (char*)memchr(buf + len - 1000, ',', 1000);
+	*q = ' ';
+	expect_parse_parallel(buf, len, 4, NULL);
+	*q = ',';
+	q = (char*)memchr(buf + len / 2, '\"', len / 2);
+	*q = 'x';
+	expect_parse_parallel(buf, len, 3, NULL);
+	*q = '\"';
+	buf[len - 1] = 'x';
+	expect_parse_parallel(buf, len, 4, NULL);
+	EXPECT_EQ_INT(LYNX_PARSE_ROOT_NOT_SINGULAR, lynx_parse_parallel(&v, buf, len, 4, NULL));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));
+	buf[len - 1] = '\n';
+
+	//嵌套层数的限制包括外层的数组
+	memset(&opt, 0, sizeof(opt));
+	opt.max_depth = 5;
+	expect_parse_parallel(buf, len, 4, &opt);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_parallel(&v, buf, len, 4, &opt));
+	lynx_free(&v);
+	opt.max_depth = 4;
+	expect_parse_parallel(buf, len, 4, &opt);
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_parse_parallel(&v, buf, len, 4, &opt));
+
+	//根节点不是数组或者输入很小时按顺序解析
+	expect_parse_parallel("[1, 2, [3]]", 11, 4, NULL);
+	expect_parse_parallel(" [ ] ", 5, 4, NULL);
+	expect_parse_parallel("{\"a\": [1]}", 10, 4, NULL);
+	expect_parse_parallel("[1, 2", 5, 4, NULL);
+	free(buf);
+}
+
+static void test_parse_depth()
+{
+	lynx_parse_options opt;
+	lynx_document* doc = lynx_document_create();
+	lynx_push_parser* pp;
+	lynx_value v;
+	char* json;
+
+	//默认限制
+	json = test_nested_array(LYNX_PARSE_DEFAULT_MAX_DEPTH);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));
+	lynx_free(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, json));
+	free(json);
+	json = test_nested_array(LYNX_PARSE_DEFAULT_MAX_DEPTH + 1);
+	TEST_ERROR(LYNX_PARSE_DEPTH_EXCEEDED, json);
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_document_parse(doc, json));
+	free(json);
+	//恶意的深层嵌套不会耗尽调用栈
+	json = test_nested_array(1000000);
+	json[1000000] = '\0';
+	TEST_ERROR(LYNX_PARSE_DEPTH_EXCEEDED, json);
+
+	memset(&opt, 0, sizeof(opt));
+	opt.max_depth = 1000000;
+	EXPECT_EQ_INT(LYNX_PARSE_EXPECT_VALUE, lynx_parse_ex(&v, json, &opt));
+	free(json);
+	json = test_nested_array(20000);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&v, json, &opt));
+	lynx_free(&v);
+	free(json);
+
+	opt.max_depth = 2;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&v, "[[1], {\"a\": 2}, {}]", &opt));
+	EXPECT_EQ_SIZE_T(3, lynx_get_array_size(&v));
+	lynx_free(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&v, "{\"a\": {\"b\": 1}, \"c\": [2]}", &opt));
+	lynx_free(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_parse_ex(&v, "[[[1]]]", &opt));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));
+	//出错时释放已经解析出的部分
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_parse_ex(&v, "{\"a\": \"str\", \"b\": [\"x\", {\"c\": 1}]}", &opt));
+
+	pp = lynx_push_parser_create_ex(&opt);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_push_parser_feed(pp, "[[1], [", 7));
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_push_parser_feed(pp, "[]]]", 4));
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_push_parser_finish(pp, &v));
+	lynx_push_parser_destroy(pp);
+	lynx_document_destroy(doc);
+}
+
 static void test_parse_expect_value()
 {
 	TEST_ERROR(LYNX_PARSE_EXPECT_VALUE, "");
@@ -319,6 +970,8 @@ static void test_parse_number_too_big()
 {
 	TEST_ERROR(LYNX_PARSE_NUMBER_TOO_BIG, "1.0e309");
 	TEST_ERROR(LYNX_PARSE_NUMBER_TOO_BIG, "-2.0e309");
+	TEST_ERROR(LYNX_PARSE_NUMBER_TOO_BIG, "1.7976931348623159e308");
+	TEST_ERROR(LYNX_PARSE_NUMBER_TOO_BIG, "1e99999999999");
 }
 
 static void test_parse_missing_quotation_mark()
@@ -338,6 +991,7 @@ static void test_parse_invalid_string_char()
 {
 	TEST_ERROR(LYNX_PARSE_INVALID_STRING_CHAR, "\"\x01\"");
 	TEST_ERROR(LYNX_PARSE_INVALID_STRING_CHAR, "\"\x1F\"");
+	TEST_ERROR(LYNX_PARSE_INVALID_STRING_CHAR, "\"0123456789abcdef0123456789abcdef0123456789\x1F\"");
 }
 
 static void test_parse_invalid_unicode_hex()
@@ -354,6 +1008,7 @@ static void test_parse_invalid_unicode_hex()
 	TEST_ERROR(LYNX_PARSE_INVALID_UNICODE_HEX, "\"\\u00G0\"");
 	TEST_ERROR(LYNX_PARSE_INVALID_UNICODE_HEX, "\"\\u000/\"");
 	TEST_ERROR(LYNX_PARSE_INVALID_UNICODE_HEX, "\"\\u000G\"");
+	TEST_ERROR(LYNX_PARSE_INVALID_UNICODE_HEX, "\"abc\\u00G0\"");
 }
 
 static void test_parse_invalid_unicode_surrogate()
@@ -425,6 +1080,40 @@ static void test_access_string()
 	lynx_free(&v);
 }
 
+//短字符串（包括键）的长度边界
+static void test_access_short_string()
+{
+	static const char text[] = "0123456789abcdef\0ghijklmnopqrstuvwxyz";
+	lynx_value v, o, c;
+	size_t len;
+#if defined(LYNX_COMPACT_SIZE) && UINTPTR_MAX == UINT64_MAX
+	EXPECT_EQ_SIZE_T(16, sizeof(lynx_value));
+	EXPECT_EQ_SIZE_T(13, LYNX_SHORT_STRING_MAX);
+#endif
+	lynx_init(&v);
+	lynx_init(&c);
+	lynx_init(&o);
+	lynx_set_object(&o, 0);
+	for (len = LYNX_SHORT_STRING_MAX - 1; len <= LYNX_SHORT_STRING_MAX + 1; len++) {
+		lynx_set_string(&v, text, len);
+		EXPECT_EQ_SIZE_T(len, lynx_get_string_length(&v));
+		EXPECT_TRUE(memcmp(text, lynx_get_string(&v), len) == 0 && lynx_get_string(&v)[len] == '\0');
+		lynx_copy(&c, &v);
+		EXPECT_TRUE(lynx_is_equal(&v, &c));
+		lynx_move(lynx_set_object_value(&o, text, len), &c);
+	}
+	EXPECT_EQ_SIZE_T(3, lynx_get_object_size(&o));
+	for (len = LYNX_SHORT_STRING_MAX - 1; len <= LYNX_SHORT_STRING_MAX + 1; len++) {
+		lynx_value* e = lynx_find_object_value(&o, text, len);
+		EXPECT_TRUE(e != NULL);
+		if (e) EXPECT_EQ_SIZE_T(len, lynx_get_string_length(e));
+	}
+	EXPECT_EQ_SIZE_T(LYNX_SHORT_STRING_MAX, lynx_get_object_key_length(&o, 1));
+	EXPECT_TRUE(lynx_get_object_key(&o, 1)[LYNX_SHORT_STRING_MAX] == '\0');
+	lynx_free(&o);
+	lynx_free(&v);
+}
+
 static void test_access_boolean()
 {
 	lynx_value v;
@@ -585,14 +1274,775 @@ static void test_access_object() {
     lynx_free(&o);
 }
 
+//统计申请和释放次数的分配器
+typedef struct {
+	long mallocs, frees, live;
+} counting_stat;
+
+static void* counting_malloc(void* ud, size_t size)
+{
+	counting_stat* st = (counting_stat*)ud;
+	++st->mallocs; ++st->live;
+	return malloc(size);
+}
+
+static void* counting_realloc(void* ud, void* ptr, size_t size)
+{
+	counting_stat* st = (counting_stat*)ud;
+	if (!ptr) { ++st->mallocs; ++st->live; }
+	return realloc(ptr, size);
+}
+
+static void counting_free(void* ud, void* ptr)
+{
+	counting_stat* st = (counting_stat*)ud;
+	if (ptr) { ++st->frees; --st->live; }
+	free(ptr);
+}
+
+static void test_access_object_index() {
+    lynx_value o, c;
+    lynx_document* doc;
+    char key[16], json[2048], *out, *p;
+    size_t i, len;
+
+    lynx_init(&o);
+    lynx_set_object(&o, 0);
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "k%d", (int)i);
+        lynx_set_int64(lynx_set_object_value(&o, key, strlen(key)), (int64_t)i);
+    }
+    EXPECT_EQ_SIZE_T(1000, lynx_get_object_size(&o));
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "k%d", (int)i);
+        EXPECT_EQ_SIZE_T(i, lynx_find_object_index(&o, key, strlen(key))); /* 保持插入顺序 */
+    }
+    EXPECT_TRUE(lynx_find_object_index(&o, "k1000", 5) == LYNX_KEY_NOT_EXIST);
+    EXPECT_EQ_INT64(10, lynx_get_int64(lynx_set_object_value(&o, "k10", 3)));
+    EXPECT_EQ_SIZE_T(1000, lynx_get_object_size(&o));
+
+    lynx_remove_object_value(&o, 0);
+    EXPECT_TRUE(lynx_find_object_index(&o, "k0", 2) == LYNX_KEY_NOT_EXIST);
+    EXPECT_EQ_SIZE_T(0, lynx_find_object_index(&o, "k1", 2));
+    EXPECT_EQ_SIZE_T(998, lynx_find_object_index(&o, "k999", 4));
+
+    lynx_reserve_object(&o, 4000);
+    EXPECT_EQ_SIZE_T(998, lynx_find_object_index(&o, "k999", 4));
+    lynx_shrink_object(&o);
+    EXPECT_EQ_SIZE_T(999, lynx_get_object_capacity(&o));
+    EXPECT_EQ_SIZE_T(998, lynx_find_object_index(&o, "k999", 4));
+
+    lynx_init(&c);
+    lynx_copy(&c, &o);
+    EXPECT_EQ_SIZE_T(998, lynx_find_object_index(&c, "k999", 4));
+    EXPECT_TRUE(lynx_is_equal(&o, &c));
+    lynx_free(&c);
+
+    lynx_clear_object(&o);
+    EXPECT_TRUE(lynx_find_object_index(&o, "k1", 2) == LYNX_KEY_NOT_EXIST);
+    lynx_set_object_value(&o, "x", 1);
+    EXPECT_EQ_SIZE_T(0, lynx_find_object_index(&o, "x", 1));
+    lynx_free(&o);
+
+    /* 小对象按需建立索引 */
+    EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&o, "{\"a\":1,\"b\":2}"));
+    lynx_build_object_index(&o);
+    EXPECT_EQ_SIZE_T(1, lynx_find_object_index(&o, "b", 1));
+    EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&o, &out, &len));
+    EXPECT_EQ_STRING("{\"a\":1,\"b\":2}", out, len);
+    free(out);
+    lynx_free(&o);
+
+    /* 解析出的大对象自动建立索引 */
+    p = json;
+    *p++ = '{';
+    for (i = 0; i < 100; i++)
+        p += sprintf(p, "%s\"k%d\":%d", i ? "," : "", (int)i, (int)i);
+    strcpy(p, "}");
+    EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&o, json));
+    EXPECT_EQ_SIZE_T(99, lynx_find_object_index(&o, "k99", 3));
+    EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify(&o, &out, &len));
+    EXPECT_EQ_SIZE_T(strlen(json), len);
+    EXPECT_TRUE(memcmp(json, out, len) == 0);
+    free(out);
+    lynx_free(&o);
+
+    doc = lynx_document_create();
+    EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, json));
+    EXPECT_EQ_SIZE_T(42, lynx_find_object_index(lynx_document_root(doc), "k42", 3));
+    lynx_set_boolean(lynx_set_object_value(lynx_document_root(doc), "new", 3), 1);
+    EXPECT_EQ_SIZE_T(100, lynx_find_object_index(lynx_document_root(doc), "new", 3));
+    EXPECT_EQ_SIZE_T(42, lynx_find_object_index(lynx_document_root(doc), "k42", 3));
+    lynx_remove_object_value(lynx_document_root(doc), 0);
+    EXPECT_EQ_SIZE_T(41, lynx_find_object_index(lynx_document_root(doc), "k42", 3));
+    lynx_document_destroy(doc);
+}
+
+#define TEST_EQUAL(json1, json2, equality) \
+    do {\
+        lynx_value v1, v2;\
+        lynx_init(&v1);\
+        lynx_init(&v2);\
+        EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v1, json1));\
+        EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v2, json2));\
+        EXPECT_EQ_INT(equality, lynx_is_equal(&v1, &v2));\
+        EXPECT_EQ_INT(equality, lynx_is_equal(&v2, &v1));\
+        lynx_free(&v1);\
+        lynx_free(&v2);\
+    } while(0)
+
+static void test_equal() {
+    lynx_value a, b;
+    char json1[4096], json2[4096], *p1, *p2;
+    double zero = 0.0;
+    int i;
+
+    TEST_EQUAL("true", "true", 1);
+    TEST_EQUAL("true", "false", 0);
+    TEST_EQUAL("false", "false", 1);
+    TEST_EQUAL("null", "null", 1);
+    TEST_EQUAL("null", "0", 0);
+    TEST_EQUAL("123", "123", 1);
+    TEST_EQUAL("123", "456", 0);
+    TEST_EQUAL("0", "-0", 1);
+    TEST_EQUAL("1", "1.0", 1);
+    TEST_EQUAL("1e-20", "1.0000000000000001e-20", 0); /* 按精确值比较 */
+    TEST_EQUAL("\"abc\"", "\"abc\"", 1);
+    TEST_EQUAL("\"abc\"", "\"abd\"", 0);
+    TEST_EQUAL("[]", "[]", 1);
+    TEST_EQUAL("[]", "null", 0);
+    TEST_EQUAL("[1,2,3]", "[1,2,3]", 1);
+    TEST_EQUAL("[1,2,3]", "[1,2,3,4]", 0);
+    TEST_EQUAL("[[]]", "[[]]", 1);
+    TEST_EQUAL("{}", "{}", 1);
+    TEST_EQUAL("{}", "null", 0);
+    TEST_EQUAL("{}", "[]", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2}", 1);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}", 1);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":3}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2,\"c\":3}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"c\":2}", 0);
+    TEST_EQUAL("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":{}}}}", 1);
+    TEST_EQUAL("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":[]}}}", 0);
+
+    /* 大对象：前半部分顺序相同，后半部分顺序相反 */
+    p1 = json1;
+    p2 = json2;
+    *p1++ = *p2++ = '{';
+    for (i = 0; i < 200; i++) {
+        p1 += sprintf(p1, "%s\"k%d\":%d", i ? "," : "", i, i);
+        p2 += sprintf(p2, "%s\"k%d\":%d", i ? "," : "", i < 100 ? i : 299 - i, i < 100 ? i : 299 - i);
+    }
+    strcpy(p1, "}");
+    strcpy(p2, "}");
+    TEST_EQUAL(json1, json2, 1);
+    strcpy(p2 - 2, "0}");
+    TEST_EQUAL(json1, json2, 0);
+
+    lynx_init(&a);
+    EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&a, json1));
+    EXPECT_TRUE(lynx_is_equal(&a, &a));
+    lynx_init(&b);
+    lynx_set_number(&b, zero / zero);
+    EXPECT_FALSE(lynx_is_equal(&b, lynx_get_object_value(&a, 0)));
+    EXPECT_FALSE(lynx_is_equal(&b, &b));
+    lynx_free(&a);
+
+    /* 同一个数组直接视为相等，不比较其中的NaN */
+    lynx_set_array(&a, 1);
+    lynx_set_number(lynx_pushback_array_element(&a), zero / zero);
+    EXPECT_FALSE(lynx_is_equal(lynx_get_array_element(&a, 0), lynx_get_array_element(&a, 0)));
+    EXPECT_TRUE(lynx_is_equal(&a, &a));
+    lynx_free(&a);
+}
+
+//路径求值的结果应与逐步调用lynx_find_object_value()/lynx_get_array_element()相同
+#define TEST_PATH(expect, root, pointer)\
+	do {\
+		lynx_path* p = lynx_path_compile(pointer);\
+		EXPECT_TRUE(p != NULL);\
+		if (p) {\
+			EXPECT_TRUE(lynx_path_eval(p, root) == (expect));\
+			lynx_path_free(p);\
+		}\
+	} while (0)
+
+static void test_path()
+{
+	static const char* const pointers[] = { "/a/b/0", "/a/b/1", "/a/c", "/a/x/y", "/a/c", "/k7", "", "/a/b/0/z" };
+	lynx_path* paths[8];
+	lynx_value* out[8];
+	lynx_value v, *a, *b;
+	char json[512], *p;
+	size_t i;
+
+	lynx_init(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, "{\"a\":{\"b\":[10,{\"z\":1}],\"c\":\"s\"},\"m~n\":1,\"x/y\":2,\"\":3,\"01\":4}"));
+	a = lynx_find_object_value(&v, "a", 1);
+	b = lynx_find_object_value(a, "b", 1);
+	TEST_PATH(&v, &v, "");
+	TEST_PATH(a, &v, "/a");
+	TEST_PATH(lynx_get_array_element(b, 0), &v, "/a/b/0");
+	TEST_PATH(lynx_find_object_value(lynx_get_array_element(b, 1), "z", 1), &v, "/a/b/1/z");
+	TEST_PATH(lynx_find_object_value(&v, "m~n", 3), &v, "/m~0n");
+	TEST_PATH(lynx_find_object_value(&v, "x/y", 3), &v, "/x~1y");
+	TEST_PATH(lynx_find_object_value(&v, "", 0), &v, "/");
+	TEST_PATH(lynx_find_object_value(&v, "01", 2), &v, "/01");
+	TEST_PATH(NULL, &v, "/a/b/2");
+	TEST_PATH(NULL, &v, "/a/b/-");
+	TEST_PATH(NULL, &v, "/a/b/01");
+	TEST_PATH(NULL, &v, "/a/b/99999999999999999999999");
+	TEST_PATH(NULL, &v, "/a/c/0");
+	TEST_PATH(NULL, &v, "/b");
+	EXPECT_TRUE(lynx_path_compile("a") == NULL);
+	EXPECT_TRUE(lynx_path_compile("/a~2") == NULL);
+	EXPECT_TRUE(lynx_path_compile("/a~") == NULL);
+
+	//带哈希索引的对象
+	lynx_free(&v);
+	p = json;
+	*p++ = '{';
+	for (i = 0; i < 40; i++)
+		p += sprintf(p, "%s\"k%d\":%d", i ? "," : "", (int)i, (int)i);
+	strcpy(p, ",\"a\":{\"b\":[1,2],\"c\":3}}");
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse(&v, json));
+	TEST_PATH(lynx_find_object_value(&v, "k39", 3), &v, "/k39");
+	TEST_PATH(NULL, &v, "/k40");
+
+	for (i = 0; i < 8; i++)
+		paths[i] = lynx_path_compile(pointers[i]);
+	lynx_path_eval_batch((const lynx_path* const*)paths, 8, &v, out);
+	for (i = 0; i < 8; i++) {
+		EXPECT_TRUE(out[i] == lynx_path_eval(paths[i], &v));
+		lynx_path_free(paths[i]);
+	}
+	EXPECT_TRUE(out[0] != NULL && lynx_get_int64(out[0]) == 1);
+	EXPECT_TRUE(out[3] == NULL);
+	EXPECT_TRUE(out[6] == &v);
+	EXPECT_TRUE(out[7] == NULL);
+	lynx_free(&v);
+}
+
+#define TEST_LAZY_ERROR(error, json)\
+	do {\
+		lynx_lazy r;\
+		EXPECT_EQ_INT(error, lynx_lazy_parse(&r, json, strlen(json)));\
+	} while (0)
+
+static void test_lazy()
+{
+	static const char json[] = " {\"id\": 18446744073709551615, \"skip\": [1, \"]}\\\"\", {\"x\": [[]]}], \"k\\u0065y\": true,"
+		" \"n\": -12, \"f\": 2.5, \"s\": \"a\\tb\", \"bad\": 01, \"a\": [null, {\"b\": false}]} ";
+	static const char strings[] = "[\"no escapes here\", \"caf\\u00e9\"]";
+	lynx_lazy root, v, e;
+	lynx_value s;
+	int64_t i;
+	double d;
+	int b;
+	char buf[8];
+	const char* str;
+	size_t len;
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_parse(&root, json, sizeof(json) - 1));
+	EXPECT_EQ_INT(LYNX_OBJECT, lynx_lazy_get_type(&root));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "n", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_int64(&v, &i));
+	EXPECT_EQ_INT64(-12, i);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "f", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_number(&v, &d));
+	EXPECT_EQ_DOUBLE(2.5, d);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "id", 2, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_NUMBER_TOO_BIG, lynx_lazy_get_int64(&v, &i));
+	//含转义的键
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "key", 3, &v));
+	EXPECT_EQ_INT(LYNX_TRUE, lynx_lazy_get_type(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_boolean(&v, &b));
+	EXPECT_TRUE(b);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "s", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_value(&v, &s));
+	EXPECT_EQ_STRING("a\tb", lynx_get_string(&s), lynx_get_string_length(&s));
+	lynx_free(&s);
+	//读取字符串不创建节点：不含转义时指向输入，含转义时解码到缓冲区中
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_string(&v, buf, sizeof(buf), &str, &len));
+	EXPECT_TRUE(str == buf);
+	EXPECT_EQ_STRING("a\tb", str, len);
+	EXPECT_EQ_INT(LYNX_PARSE_BUFFER_TOO_SMALL, lynx_lazy_get_string(&v, buf, 2, &str, &len));
+	EXPECT_EQ_SIZE_T(3, len);
+	//非法的值只在读取时报告
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "bad", 3, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_lazy_get_int64(&v, &i));
+	EXPECT_EQ_INT(LYNX_PARSE_NOT_FOUND, lynx_lazy_find(&root, "none", 4, &v));
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "skip", 4, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&v, 1, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_value(&e, &s));
+	EXPECT_EQ_STRING("]}\"", lynx_get_string(&s), lynx_get_string_length(&s));
+	lynx_free(&s);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&v, 2, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_value(&e, &s));
+	EXPECT_EQ_INT(LYNX_OBJECT, lynx_get_type(&s));
+	lynx_free(&s);
+	EXPECT_EQ_INT(LYNX_PARSE_NOT_FOUND, lynx_lazy_get_element(&v, 3, &e));
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&root, "a", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&v, 0, &e));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_lazy_get_type(&e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&v, 1, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_find(&e, "b", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_boolean(&v, &b));
+	EXPECT_FALSE(b);
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_parse(&root, strings, sizeof(strings) - 1));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&root, 0, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_string(&e, NULL, 0, &str, &len));
+	EXPECT_TRUE(str == strings + 2);
+	EXPECT_EQ_STRING("no escapes here", str, len);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_element(&root, 1, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_get_string(&e, buf, sizeof(buf), &str, &len));
+	EXPECT_EQ_STRING("caf\xC3\xA9", str, len);
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_parse(&root, "[]", 2));
+	EXPECT_EQ_INT(LYNX_PARSE_NOT_FOUND, lynx_lazy_get_element(&root, 0, &e));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_parse(&root, "{\"a\" 1}", 7));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COLON, lynx_lazy_find(&root, "a", 1, &v));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_lazy_parse(&root, "[1 2]", 5));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lynx_lazy_get_element(&root, 1, &e));
+
+	//结构错误在lynx_lazy_parse()时就能发现
+	TEST_LAZY_ERROR(LYNX_PARSE_EXPECT_VALUE, " ");
+	TEST_LAZY_ERROR(LYNX_PARSE_ROOT_NOT_SINGULAR, "null x");
+	TEST_LAZY_ERROR(LYNX_PARSE_ROOT_NOT_SINGULAR, "[] []");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[1}");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":[]");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1]");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_QUOTATION_MARK, "[\"abc]");
+	TEST_LAZY_ERROR(LYNX_PARSE_MISS_QUOTATION_MARK, "\"\\\"");
+	TEST_LAZY_ERROR(LYNX_PARSE_INVALID_VALUE, "]");
+}
+
+//常用的合法和非法JSON文本，用于与lynx_parse()的结果做比较
+static const char* const json_cases[] = {
+	"null", " true ", "false", "0", "-0", "123", "-1.5e+10", "1.7976931348623157e308",
+	"18446744073709551615", "9007199254740993.0", "\"\"", "\"Hello\\nWorld\"",
+	"\"\\\" \\\\ \\/ \\b \\f \\n \\r \\t\"", "\"0123456789abcdef0123456789abcdef\\\"0123456789abcdef0123456789abcdef\\\\\"", "\"\\u0024 \\u00A2 \\u20AC \\uD834\\uDD1E\"",
+	"[]", "[ null , false , true , 123 , \"abc\" ]", "[ [ ] , [ 0 ] , [ 0 , 1 ] , [ 0 , 1 , 2 ] ]",
+	"{}", " { \"n\" : null , \"f\" : false , \"i\" : 123 , \"s\" : \"abc\", \"a\" : [ 1, 2, 3 ], \"o\" : { \"1\" : 1, \"2\" : 2 } } ",
+	"{\"k\\u0041\":[{\"x\":{}},[[]],\"\\\"\"]}",
+	"[\"0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz\",                                  0]",
+	/* 错误 */
+	"", " ", "nul", "?", "nulx", "nullx", "truex", "1.2.3", "1-", "[1.]", "+1", ".1", "1.", "1e", "INF", "nan",
+	"0x0", "0123", "1e309", "-1e309", "null x", "[1,]", "[\"a\", nul]", "[1", "[1}", "[1 2", "[[]", "[", "{",
+	"{:1,", "{1:1,", "{\"a\":1,", "{\"a\"}", "{\"a\",\"b\"}", "{\"a\":1", "{\"a\":1]", "{\"a\":1 \"b\"", "{\"a\":{}",
+	"\"", "\"abc", "\"\\v\"", "\"\\0\"", "\"\x01\"", "\"\\u\"", "\"\\u012\"", "\"\\uD800\"", "\"\\uD800\\uE000\"",
+};
+
+//把json复制到恰好len字节的缓冲区中（没有'\0'结尾，越界读取可以被AddressSanitizer发现），结果应与lynx_parse()相同
+static void test_parse_n_json(const char* json)
+{
+	lynx_value expect, actual;
+	lynx_parse_options opt;
+	size_t len = strlen(json);
+	char* buf = (char*)malloc(len > 0 ? len : 1);
+	int expect_ret;
+	lynx_init(&expect);
+	expect_ret = lynx_parse(&expect, json);
+	memcpy(buf, json, len);
+	EXPECT_EQ_INT(expect_ret, lynx_parse_n(&actual, buf, len));
+	if (expect_ret == LYNX_PARSE_OK)
+		EXPECT_TRUE(lynx_is_equal(&expect, &actual));
+	lynx_free(&actual);
+	free(buf);
+	//填充字节的内容是任意的，不能影响结果
+	buf = (char*)malloc(len + LYNX_PARSE_PADDING);
+	memcpy(buf, json, len);
+	memset(buf + len, ' ', LYNX_PARSE_PADDING / 2);
+	memset(buf + len + LYNX_PARSE_PADDING / 2, '\"', LYNX_PARSE_PADDING / 2);
+	memset(&opt, 0, sizeof(opt));
+	opt.padding = LYNX_PARSE_PADDING;
+	EXPECT_EQ_INT(expect_ret, lynx_parse_n_ex(&actual, buf, len, &opt));
+	if (expect_ret == LYNX_PARSE_OK)
+		EXPECT_TRUE(lynx_is_equal(&expect, &actual));
+	lynx_free(&actual);
+	lynx_free(&expect);
+	free(buf);
+}
+
+static void test_parse_n()
+{
+	lynx_value v;
+	size_t i;
+	for (i = 0; i < sizeof(json_cases) / sizeof(json_cases[0]); i++)
+		test_parse_n_json(json_cases[i]);
+
+	//只解析给定的一段
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_n(&v, "[1,2]3", 5));
+	EXPECT_EQ_SIZE_T(2, lynx_get_array_size(&v));
+	lynx_free(&v);
+	EXPECT_EQ_INT(LYNX_PARSE_ROOT_NOT_SINGULAR, lynx_parse_n(&v, "[1,2]3", 6));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_n(&v, "123456", 3));
+	EXPECT_EQ_INT64(123, lynx_get_int64(&v));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_parse_n(&v, "true", 3));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_QUOTATION_MARK, lynx_parse_n(&v, "\"abc\"", 4));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_UNICODE_HEX, lynx_parse_n(&v, "\"\\u00410\"", 6));
+	EXPECT_EQ_INT(LYNX_PARSE_EXPECT_VALUE, lynx_parse_n(&v, "1", 0));
+
+	//范围内的'\0'不是结尾
+	EXPECT_EQ_INT(LYNX_PARSE_ROOT_NOT_SINGULAR, lynx_parse_n(&v, "1\0", 2));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_STRING_CHAR, lynx_parse_n(&v, "\"a\0b\"", 5));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lynx_parse_n(&v, "[1\0]", 4));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_parse_n(&v, "\0", 1));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_parse_n(&v, "[\0]", 3));
+}
+
+//json放在恰好len字节的缓冲区中，结果应与lynx_parse()相同
+static void test_tape_json(lynx_tape* t, const char* json)
+{
+	lynx_value expect, actual;
+	size_t len = strlen(json);
+	char* buf = (char*)malloc(len > 0 ? len : 1);
+	int expect_ret;
+	lynx_init(&expect);
+	expect_ret = lynx_parse(&expect, json);
+	memcpy(buf, json, len);
+	EXPECT_EQ_INT(expect_ret, lynx_tape_parse(t, buf, len));
+	if (expect_ret == LYNX_PARSE_OK) {
+		lynx_tape_to_value(t, LYNX_TAPE_ROOT, &actual);
+		EXPECT_TRUE(lynx_is_equal(&expect, &actual));
+		lynx_free(&actual);
+	}
+	lynx_free(&expect);
+	free(buf);
+}
+
+static void test_tape()
+{
+	static const char json[] = "{\"a\": [1, -2, 18446744073709551615, 2.5], \"s\": \"x\\u0041\\\"\", \"o\": {\"t\": true, \"f\": false, \"n\": null}, \"e\": []}";
+	lynx_tape* t = lynx_tape_create();
+	size_t v, e, i, j;
+	char buf[160];
+	char* deep;
+
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_tape_parse(t, json, sizeof(json) - 1));
+	EXPECT_EQ_INT(LYNX_OBJECT, lynx_tape_get_type(t, LYNX_TAPE_ROOT));
+	EXPECT_EQ_SIZE_T(4, lynx_tape_get_object_size(t, LYNX_TAPE_ROOT));
+	v = lynx_tape_find_object_value(t, LYNX_TAPE_ROOT, "a", 1);
+	EXPECT_EQ_SIZE_T(4, lynx_tape_get_array_size(t, v));
+	e = lynx_tape_get_array_element(t, v, 1);
+	EXPECT_TRUE(lynx_tape_is_int64(t, e));
+	EXPECT_EQ_INT64(-2, lynx_tape_get_int64(t, e));
+	EXPECT_EQ_UINT64(18446744073709551615u, lynx_tape_get_uint64(t, lynx_tape_get_array_element(t, v, 2)));
+	EXPECT_EQ_DOUBLE(2.5, lynx_tape_get_number(t, lynx_tape_get_array_element(t, v, 3)));
+	v = lynx_tape_find_object_value(t, LYNX_TAPE_ROOT, "s", 1);
+	EXPECT_EQ_STRING("xA\"", lynx_tape_get_string(t, v), lynx_tape_get_string_length(t, v));
+	v = lynx_tape_find_object_value(t, LYNX_TAPE_ROOT, "o", 1);
+	EXPECT_TRUE(lynx_tape_get_boolean(t, lynx_tape_find_object_value(t, v, "t", 1)));
+	EXPECT_FALSE(lynx_tape_get_boolean(t, lynx_tape_find_object_value(t, v, "f", 1)));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_tape_get_type(t, lynx_tape_find_object_value(t, v, "n", 1)));
+	EXPECT_EQ_SIZE_T(LYNX_KEY_NOT_EXIST, lynx_tape_find_object_value(t, v, "x", 1));
+	//遍历：跳过子节点
+	for (i = LYNX_TAPE_ROOT + 1, j = 0; i != lynx_tape_end(t, LYNX_TAPE_ROOT); i = lynx_tape_next(t, i), j++);
+	EXPECT_EQ_SIZE_T(8, j);
+	v = lynx_tape_find_object_value(t, LYNX_TAPE_ROOT, "e", 1);
+	EXPECT_EQ_SIZE_T(v + 1, lynx_tape_end(t, v));
+
+	for (i = 0; i < sizeof(json_cases) / sizeof(json_cases[0]); i++)
+		test_tape_json(t, json_cases[i]);
+	//引号和反斜杠出现在64字节分块的边界附近
+	for (i = 50; i < 80; i++) {
+		for (j = 1; j <= 4; j++) {
+			memset(buf, ' ', sizeof(buf));
+			buf[0] = '[';
+			buf[i - 1] = '\"';
+			memset(buf + i, '\\', j);
+			buf[i + j] = '\"';
+			buf[i + j + 1] = '\"';
+			buf[i + j + 2] = ']';
+			buf[i + j + 3] = '\0';
+			test_tape_json(t, buf);
+			buf[i + j + 1] = ']';
+			buf[i + j + 2] = '\0';
+			test_tape_json(t, buf);
+		}
+	}
+	//深度限制
+	deep = (char*)malloc(LYNX_PARSE_DEFAULT_MAX_DEPTH + 1);
+	memset(deep, '[', LYNX_PARSE_DEFAULT_MAX_DEPTH + 1);
+	EXPECT_EQ_INT(LYNX_PARSE_EXPECT_VALUE, lynx_tape_parse(t, deep, LYNX_PARSE_DEFAULT_MAX_DEPTH));
+	EXPECT_EQ_INT(LYNX_PARSE_DEPTH_EXCEEDED, lynx_tape_parse(t, deep, LYNX_PARSE_DEFAULT_MAX_DEPTH + 1));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_tape_get_type(t, LYNX_TAPE_ROOT));
+	free(deep);
+	//范围内的'\0'与其他非法字符一样
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_tape_parse(t, "\0", 1));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_tape_parse(t, "[\0]", 3));
+	lynx_tape_destroy(t);
+}
+
+static void test_write_file(const char* path, const char* data, size_t len)
+{
+	FILE* fp = fopen(path, "wb");
+	EXPECT_TRUE(fp != NULL);
+	if (fp) {
+		EXPECT_EQ_SIZE_T(len, fwrite(data, 1, len, fp));
+		fclose(fp);
+	}
+}
+
+static void test_parse_file()
+{
+	static const char* const path = "lynx_test_file.json";
+	const int flags[] = { 0, LYNX_FILE_NO_MMAP };
+	lynx_value v;
+	size_t size = 65536, i;	//是常见页面大小的整数倍，文件之后没有可读的字节
+	char* big = (char*)malloc(size);
+	for (i = 0; i < 2; i++) {
+		test_write_file(path, "{\"a\": [1, 2.5, \"\\u4F60\"]}", 25);
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_file(&v, path, flags[i]));
+		EXPECT_EQ_SIZE_T(3, lynx_get_array_size(lynx_find_object_value(&v, "a", 1)));
+		lynx_free(&v);
+
+		//文件在字符串中间结束
+		memset(big, 'x', size);
+		big[0] = '[';
+		big[1] = '\"';
+		test_write_file(path, big, size);
+		EXPECT_EQ_INT(LYNX_PARSE_MISS_QUOTATION_MARK, lynx_parse_file(&v, path, flags[i]));
+		big[size - 2] = '\"';
+		big[size - 1] = ']';
+		test_write_file(path, big, size);
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_file(&v, path, flags[i]));
+		EXPECT_EQ_SIZE_T(size - 4, lynx_get_string_length(lynx_get_array_element(&v, 0)));
+		lynx_free(&v);
+		//文件在空白中间结束
+		memset(big, ' ', size);
+		big[0] = '0';
+		test_write_file(path, big, size);
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_file(&v, path, flags[i]));
+		EXPECT_EQ_INT64(0, lynx_get_int64(&v));
+
+		test_write_file(path, "", 0);
+		EXPECT_EQ_INT(LYNX_PARSE_EXPECT_VALUE, lynx_parse_file(&v, path, flags[i]));
+		remove(path);
+		v.type = LYNX_FALSE;
+		EXPECT_EQ_INT(LYNX_PARSE_FILE_ERROR, lynx_parse_file(&v, path, flags[i]));
+		EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));
+	}
+	free(big);
+}
+
+//把json按每一个位置切成两段、以及逐字节送入增量解析器，结果都应该与lynx_parse()相同
+static void test_push_json(lynx_push_parser* pp, const char* json)
+{
+	lynx_value expect, actual;
+	size_t len = strlen(json), i, j;
+	int expect_ret, ret;
+	lynx_init(&expect);
+	expect_ret = lynx_parse(&expect, json);
+	for (i = 0; i <= len + 1; i++) {
+		if (i <= len) {
+			lynx_push_parser_feed(pp, json, i);
+			lynx_push_parser_feed(pp, json + i, len - i);
+		} else {
+			for (j = 0; j < len; j++)
+				lynx_push_parser_feed(pp, json + j, 1);
+		}
+		ret = lynx_push_parser_finish(pp, &actual);
+		EXPECT_EQ_INT(expect_ret, ret);
+		if (expect_ret == LYNX_PARSE_OK)
+			EXPECT_TRUE(lynx_is_equal(&expect, &actual));
+		else
+			EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&actual));
+		lynx_free(&actual);
+	}
+	lynx_free(&expect);
+}
+
+static void test_push_parser()
+{
+	lynx_push_parser* pp = lynx_push_parser_create();
+	lynx_value v;
+	char json[] = "[1,\"2\"]\0garbage";
+	size_t i;
+	for (i = 0; i < sizeof(json_cases) / sizeof(json_cases[0]); i++)
+		test_push_json(pp, json_cases[i]);
+
+	//出错之后忽略剩下的输入
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_push_parser_feed(pp, "[1,", 3));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_push_parser_feed(pp, "x]", 2));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_push_parser_feed(pp, "]", 1));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_push_parser_finish(pp, &v));
+	EXPECT_EQ_INT(LYNX_NULL, lynx_get_type(&v));
+
+	//'\0'之后的内容被忽略
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_push_parser_feed(pp, json, sizeof(json)));
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_push_parser_finish(pp, &v));
+	EXPECT_EQ_SIZE_T(2, lynx_get_array_size(&v));
+	lynx_free(&v);
+
+	//未完成的节点在销毁时释放
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_push_parser_feed(pp, "{\"a\":[\"xyz\",{\"b\":\"ab", 20));
+	lynx_push_parser_destroy(pp);
+}
+
+static void test_allocator()
+{
+	counting_stat global = { 0, 0, 0 }, local = { 0, 0, 0 };
+	lynx_allocator ga = { counting_malloc, counting_realloc, counting_free, &global };
+	lynx_allocator la = { counting_malloc, counting_realloc, counting_free, &local };
+	lynx_parse_options opt;
+	lynx_document* doc;
+	lynx_value v, v2;
+	char* json;
+	size_t len;
+	long mallocs;
+
+	memset(&opt, 0, sizeof(opt));
+	opt.allocator = &la;
+	lynx_set_allocator(&ga);
+	EXPECT_TRUE(lynx_get_allocator()->ud == &global);
+	lynx_init(&v);
+	lynx_init(&v2);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_ex(&v, "{\"a\": [1, 2, {\"b\": \"str\"}], \"c\": \"d\"}", &opt));
+	EXPECT_TRUE(global.mallocs > 0);
+	EXPECT_TRUE(local.mallocs > 0);	//解析栈
+	EXPECT_TRUE(local.live == 0);
+	lynx_copy(&v2, &v);
+	lynx_set_string(lynx_pushback_array_element(lynx_find_object_value(&v2, "a", 1)), "x", 1);
+	lynx_remove_object_value(&v2, 1);
+	EXPECT_EQ_INT(LYNX_STRINGIFY_OK, lynx_stringify_ex(&v2, &json, &len, &la));
+	EXPECT_EQ_STRING("{\"a\":[1,2,{\"b\":\"str\"},\"x\"]}", json, len);
+	EXPECT_TRUE(local.live == 1);
+	counting_free(&local, json);
+	lynx_free(&v);
+	lynx_free(&v2);
+
+	doc = lynx_document_create_ex(&la);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, "[\"abc\", {\"k\": [true]}]"));
+	lynx_set_string(lynx_pushback_array_element(lynx_document_root(doc)), "x", 1);
+	lynx_document_destroy(doc);
+
+	//文档中的节点（包括解析时建立的索引）和修改时申请的内存都不经过全局分配器，销毁时不遍历节点
+	mallocs = global.mallocs;
+	doc = lynx_document_create_ex(&la);
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_document_parse(doc, "{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,"
+		"\"i\":9,\"j\":10,\"k\":11,\"l\":12,\"m\":13,\"n\":14,\"o\":15,\"p\":[\"a string longer than the inline buffer\"]}"));
+	EXPECT_TRUE(global.mallocs == mallocs);
+	lynx_set_boolean(lynx_set_object_value(lynx_document_root(doc), "a key longer than the inline buffer", 35), 1);
+	lynx_set_boolean(lynx_pushback_array_element(lynx_find_object_value(lynx_document_root(doc), "p", 1)), 0);
+	lynx_remove_object_value(lynx_document_root(doc), 0);
+	lynx_shrink_array(lynx_find_object_value(lynx_document_root(doc), "p", 1));
+	EXPECT_EQ_SIZE_T(15, lynx_find_object_index(lynx_document_root(doc), "a key longer than the inline buffer", 35));
+	EXPECT_TRUE(global.mallocs == mallocs);
+	EXPECT_TRUE(local.live > 0);
+	lynx_document_destroy(doc);
+
+	EXPECT_TRUE(global.live == 0);
+	EXPECT_TRUE(local.live == 0);
+	lynx_set_allocator(NULL);
+	EXPECT_TRUE(lynx_get_allocator()->ud == NULL);
+}
+
+typedef struct {
+	char buf[512];
+	size_t len;
+	int events, stop_at;	//第stop_at个事件返回非0，中止解析
+} sax_trace;
+
+//记录一个事件：prefix和s拼接后以空格结尾
+static int sax_put(void* ctx, const char* prefix, const char* s, size_t n)
+{
+	sax_trace* t = (sax_trace*)ctx;
+	t->len += (size_t)sprintf(t->buf + t->len, "%s", prefix);
+	memcpy(t->buf + t->len, s, n);
+	t->len += n;
+	t->buf[t->len++] = ' ';
+	t->buf[t->len] = '\0';
+	return ++t->events == t->stop_at;
+}
+
+static int sax_printf(void* ctx, const char* format, long long n)
+{
+	char buf[32];
+	return sax_put(ctx, "", buf, (size_t)sprintf(buf, format, n));
+}
+
+static int sax_null(void* ctx) { return sax_put(ctx, "", "n", 1); }
+static int sax_boolean(void* ctx, int b) { return sax_put(ctx, "", b ? "t" : "f", 1); }
+static int sax_number(void* ctx, double n) { char buf[32]; return sax_put(ctx, "", buf, (size_t)sprintf(buf, "%g", n)); }
+static int sax_int64(void* ctx, int64_t i) { return sax_printf(ctx, "i%lld", (long long)i); }
+static int sax_uint64(void* ctx, uint64_t u) { char buf[32]; return sax_put(ctx, "", buf, (size_t)sprintf(buf, "u%llu", (unsigned long long)u)); }
+static int sax_string(void* ctx, const char* s, size_t len) { return sax_put(ctx, "s:", s, len); }
+static int sax_key(void* ctx, const char* s, size_t len) { return sax_put(ctx, "k:", s, len); }
+static int sax_start_object(void* ctx) { return sax_put(ctx, "", "{", 1); }
+static int sax_end_object(void* ctx, size_t size) { return sax_printf(ctx, "}%lld", (long long)size); }
+static int sax_start_array(void* ctx) { return sax_put(ctx, "", "[", 1); }
+static int sax_end_array(void* ctx, size_t size) { return sax_printf(ctx, "]%lld", (long long)size); }
+
+#define TEST_SAX(expect, h, json)\
+	do {\
+		sax_trace t;\
+		t.len = 0; t.events = 0; t.stop_at = 0;\
+		EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_sax(json, h, &t));\
+		EXPECT_EQ_STRING(expect, t.buf, t.len);\
+	} while(0)
+
+static void test_parse_sax()
+{
+	lynx_handler h = { sax_null, sax_boolean, sax_number, sax_int64, sax_uint64, sax_string, sax_key,
+		sax_start_object, sax_end_object, sax_start_array, sax_end_array };
+	lynx_handler only_numbers;
+	counting_stat global = { 0, 0, 0 };
+	lynx_allocator ga = { counting_malloc, counting_realloc, counting_free, &global };
+	sax_trace t;
+
+	memset(&only_numbers, 0, sizeof(only_numbers));
+	only_numbers.number = sax_number;
+	TEST_SAX("n ", &h, " null ");
+	TEST_SAX("[ n t f i1 i-2 1.5 u18446744073709551615 s:a\nb { k:k { }0 }1 [ ]0 ]10 ", &h,
+		"[null,true,false,1,-2,1.5,18446744073709551615,\"a\\nb\",{\"k\":{}},[]]");
+	TEST_SAX("{ k:a [ i1 i2 { k:b s:str }1 ]3 k:c s:d }2 ", &h, "{\"a\": [1, 2, {\"b\": \"str\"}], \"c\": \"d\"}");
+	TEST_SAX("1 2.5 -3 ", &only_numbers, "{\"a\": [1, \"x\", 2.5, {\"b\": -3}], \"c\": null}");
+
+	//回调返回非0时中止
+	t.len = 0; t.events = 0; t.stop_at = 3;
+	EXPECT_EQ_INT(LYNX_PARSE_TERMINATED, lynx_parse_sax("[1,2,3]", &h, &t));
+	EXPECT_EQ_STRING("[ i1 i2 ", t.buf, t.len);
+
+	t.len = 0; t.events = 0; t.stop_at = 0;
+	EXPECT_EQ_INT(LYNX_PARSE_EXPECT_VALUE, lynx_parse_sax(" ", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_VALUE, lynx_parse_sax("[nul]", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_ROOT_NOT_SINGULAR, lynx_parse_sax("1 2", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lynx_parse_sax("[1,2", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COLON, lynx_parse_sax("{\"a\" 1}", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_KEY, lynx_parse_sax("{1:1}", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_MISS_COMMA_OR_CURLY_BRACKET, lynx_parse_sax("{\"a\":1", &h, &t));
+	EXPECT_EQ_INT(LYNX_PARSE_INVALID_STRING_ESCAPE, lynx_parse_sax("[\"\\x\"]", &h, &t));
+
+	//不含转义的字符串直接指向输入，不需要任何内存分配；唯一的分配是记录嵌套层次的解析栈
+	lynx_set_allocator(&ga);
+	t.len = 0; t.events = 0; t.stop_at = 0;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_sax("\"str\"", &h, &t));
+	EXPECT_TRUE(global.mallocs == 0);
+	t.len = 0; t.events = 0; t.stop_at = 0;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_sax("{\"a\": [1, 2, {\"b\": \"str\"}], \"c\": \"d\"}", &h, &t));
+	EXPECT_TRUE(global.mallocs == 1);
+	t.len = 0; t.events = 0; t.stop_at = 0;
+	EXPECT_EQ_INT(LYNX_PARSE_OK, lynx_parse_sax("[\"a\\tb\"]", &h, &t));
+	EXPECT_EQ_STRING("[ s:a\tb ]1 ", t.buf, t.len);
+	EXPECT_TRUE(global.live == 0);
+	lynx_set_allocator(NULL);
+}
+
 static void test_access()
 {
 	test_access_null();
 	test_access_boolean();
 	test_access_number();
 	test_access_string();
+	test_access_short_string();
 	test_access_array();
 	test_access_object();
+	test_access_object_index();
 }
 
 static void test_parse()
@@ -601,9 +2051,18 @@ static void test_parse()
 	test_parse_true();
 	test_parse_false();
 	test_parse_number();
+	test_parse_int64();
 	test_parse_string();
 	test_parse_array();
 	test_parse_object();
+	test_parse_insitu();
+	test_parse_document();
+	test_parse_key_table();
+	test_parse_n();
+	test_parse_file();
+	test_parse_lines();
+	test_parse_parallel();
+	test_parse_depth();
 	test_parse_expect_value();
 	test_parse_invalid_value();
 	test_parse_root_not_singular();
@@ -623,7 +2082,16 @@ int main()
 {
 	test_parse();
 	test_access();
+	test_equal();
+	test_path();
+	test_lazy();
+	test_tape();
+	test_allocator();
+	test_parse_sax();
+	test_push_parser();
 	test_stringify();
+	test_stringify_to();
+	test_stringify_into();
 	printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
 	return main_ret;
 }
\ No newline at end of file